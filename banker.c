@@ -1,273 +1,3188 @@
+#define _DEFAULT_SOURCE // madvise and MADV_SEQUENTIAL under -std=c11
+
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BANKER_HAVE_X86_KERNELS 1
+#endif
+#ifdef BANKER_VERIFY
+#include <assert.h>
+#endif
+
+// Matrix rows are padded to a whole number of SIMD lanes and every array
+// starts on its own cache line
+#define BANKER_LANE_WIDTH 8
+#define BANKER_ALIGNMENT 64
+
+// Pointer to row i of one of the state's matrices
+#define BANKER_ROW(bs, matrix, i) ((bs)->matrix + (size_t)(i) * (bs)->stride)
+
+// Banker's Algorithm state, sized at runtime
+// Every matrix is a separate contiguous array (structure of arrays) with rows
+// of `stride` ints; padding columns are kept at zero.
+typedef struct BankerState
+{
+    int num_processes;
+    int num_resources;
+    int stride; // Row length padded to BANKER_LANE_WIDTH
+
+    int *available;  // [stride]
+    int *max;        // [num_processes * stride]
+    int *allocation; // [num_processes * stride]
+    int *need;       // [num_processes * stride]
+    int *requested;  // [num_processes * stride], outstanding requests for detection
+
+    // Incremental safety engine, stored resource-major
+    // need_order[j * n + k] is the k-th process sorted by need on resource j,
+    // need_keys holds the matching need values so cursors scan contiguously
+    // and need_rank[j * n + i] is the position of process i in that order
+    int *need_order;
+    int *need_keys;
+    int *need_rank;
+    bool known_safe;
+
+    // Cached safe sequence of the last state proven safe. Releases and
+    // rolled back grants keep it valid, so most checks only replay it.
+    int *safe_sequence;     // [num_processes]
+    int *sequence_scratch;  // [num_processes]
+    bool sequence_valid;
+
+    // Per-check counters of how many resources a process is already
+    // satisfied on, stamped with the check epoch so they never need clearing
+    int *satisfied_count;
+    unsigned int *satisfied_epoch;
+    unsigned int *target_epoch; // Stamped for processes the check waits on
+    unsigned int check_epoch;
+
+    // Scratch buffers reused by every check
+    int *work;    // [stride]
+    int *request; // [stride], padded copy of the request being checked
+    int *cursor;  // [num_resources]
+    int *ready;   // [num_processes]
+
+    // Batch admission scratch, grown on demand
+    int *batch_rows;
+    struct BatchEntry *batch_order;
+    int *batch_candidates;
+    int *batch_targets;
+    int batch_capacity;
+} BankerState;
+
+// Row kernels
+// All kernels work on whole padded rows; `length` is a multiple of
+// BANKER_LANE_WIDTH and the padding columns are zero on both sides.
+typedef bool (*RowLessEqualFn)(const int *a, const int *b, int length);
+typedef void (*RowUpdateFn)(int *dst, const int *src, int length);
+
+// Scalar kernel: true when a[k] <= b[k] for every k
+static bool row_less_equal_scalar(const int *a, const int *b, int length)
+{
+    for (int k = 0; k < length; k++)
+    {
+        if (a[k] > b[k])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Scalar kernel: dst += src
+static void row_add_scalar(int *dst, const int *src, int length)
+{
+    for (int k = 0; k < length; k++)
+    {
+        dst[k] += src[k];
+    }
+}
+
+// Scalar kernel: dst -= src
+static void row_sub_scalar(int *dst, const int *src, int length)
+{
+    for (int k = 0; k < length; k++)
+    {
+        dst[k] -= src[k];
+    }
+}
+
+#ifdef BANKER_HAVE_X86_KERNELS
+// SSE4.1 kernels, four ints per instruction
+__attribute__((target("sse4.1"))) static bool row_less_equal_sse41(const int *a, const int *b, int length)
+{
+    for (int k = 0; k < length; k += 4)
+    {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + k));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + k));
+        __m128i greater = _mm_cmpgt_epi32(va, vb);
+        if (!_mm_testz_si128(greater, greater))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+__attribute__((target("sse4.1"))) static void row_add_sse41(int *dst, const int *src, int length)
+{
+    for (int k = 0; k < length; k += 4)
+    {
+        __m128i vd = _mm_loadu_si128((const __m128i *)(dst + k));
+        __m128i vs = _mm_loadu_si128((const __m128i *)(src + k));
+        _mm_storeu_si128((__m128i *)(dst + k), _mm_add_epi32(vd, vs));
+    }
+}
+
+__attribute__((target("sse4.1"))) static void row_sub_sse41(int *dst, const int *src, int length)
+{
+    for (int k = 0; k < length; k += 4)
+    {
+        __m128i vd = _mm_loadu_si128((const __m128i *)(dst + k));
+        __m128i vs = _mm_loadu_si128((const __m128i *)(src + k));
+        _mm_storeu_si128((__m128i *)(dst + k), _mm_sub_epi32(vd, vs));
+    }
+}
+
+// AVX2 kernels, eight ints per instruction
+__attribute__((target("avx2"))) static bool row_less_equal_avx2(const int *a, const int *b, int length)
+{
+    for (int k = 0; k < length; k += 8)
+    {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + k));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + k));
+        __m256i greater = _mm256_cmpgt_epi32(va, vb);
+        if (!_mm256_testz_si256(greater, greater))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+__attribute__((target("avx2"))) static void row_add_avx2(int *dst, const int *src, int length)
+{
+    for (int k = 0; k < length; k += 8)
+    {
+        __m256i vd = _mm256_loadu_si256((const __m256i *)(dst + k));
+        __m256i vs = _mm256_loadu_si256((const __m256i *)(src + k));
+        _mm256_storeu_si256((__m256i *)(dst + k), _mm256_add_epi32(vd, vs));
+    }
+}
 
-#define MAX_PROCESSES 10
-#define MAX_RESOURCES 10
+__attribute__((target("avx2"))) static void row_sub_avx2(int *dst, const int *src, int length)
+{
+    for (int k = 0; k < length; k += 8)
+    {
+        __m256i vd = _mm256_loadu_si256((const __m256i *)(dst + k));
+        __m256i vs = _mm256_loadu_si256((const __m256i *)(src + k));
+        _mm256_storeu_si256((__m256i *)(dst + k), _mm256_sub_epi32(vd, vs));
+    }
+}
+#endif
+
+// Kernels selected for this CPU
+static RowLessEqualFn row_less_equal = row_less_equal_scalar;
+static RowUpdateFn row_add = row_add_scalar;
+static RowUpdateFn row_sub = row_sub_scalar;
+static const char *row_kernel_name = "scalar";
+
+// Pick the widest kernels the CPU supports
+void select_row_kernels()
+{
+#ifdef BANKER_HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        row_less_equal = row_less_equal_avx2;
+        row_add = row_add_avx2;
+        row_sub = row_sub_avx2;
+        row_kernel_name = "avx2";
+    }
+    else if (__builtin_cpu_supports("sse4.1"))
+    {
+        row_less_equal = row_less_equal_sse41;
+        row_add = row_add_sse41;
+        row_sub = row_sub_sse41;
+        row_kernel_name = "sse4.1";
+    }
+#endif
+}
+
+// Round a byte count up to the state alignment
+static size_t banker_align(size_t bytes)
+{
+    return (bytes + BANKER_ALIGNMENT - 1) & ~(size_t)(BANKER_ALIGNMENT - 1);
+}
+
+// Function to create a zeroed Banker state for n processes and m resources
+// All arrays are carved out of a single aligned allocation.
+BankerState *create_banker_state(int n, int m)
+{
+    if (n <= 0 || m <= 0 || m > INT32_MAX - BANKER_LANE_WIDTH)
+    {
+        return NULL;
+    }
+
+    // Every array holds at most n * stride ints; keeping that count in an
+    // int, and the byte size of all 17 arrays well inside size_t, means none
+    // of the size arithmetic below can wrap
+    size_t stride = ((size_t)m + BANKER_LANE_WIDTH - 1) / BANKER_LANE_WIDTH * BANKER_LANE_WIDTH;
+    if ((size_t)n > INT32_MAX / stride ||
+        (size_t)n * stride > SIZE_MAX / 32 / sizeof(int) - BANKER_ALIGNMENT)
+    {
+        return NULL;
+    }
+
+    BankerState *bs = calloc(1, sizeof(BankerState));
+    if (bs == NULL)
+    {
+        return NULL;
+    }
+
+    select_row_kernels();
+
+    bs->num_processes = n;
+    bs->num_resources = m;
+    bs->stride = (int)stride;
+
+    size_t row_bytes = banker_align(sizeof(int) * bs->stride);
+    size_t matrix_bytes = banker_align(sizeof(int) * (size_t)n * bs->stride);
+    size_t queue_bytes = banker_align(sizeof(int) * (size_t)n * m);
+    size_t process_bytes = banker_align(sizeof(int) * (size_t)n);
+    size_t resource_bytes = banker_align(sizeof(int) * (size_t)m);
+
+    size_t total = 3 * row_bytes + 4 * matrix_bytes + 3 * queue_bytes +
+                   6 * process_bytes + resource_bytes;
+
+    char *base = aligned_alloc(BANKER_ALIGNMENT, total);
+    if (base == NULL)
+    {
+        free(bs);
+        return NULL;
+    }
+    memset(base, 0, total);
 
-// Global variables for Banker's Algorithm
-int num_processes, num_resources;
-int allocation[MAX_PROCESSES][MAX_RESOURCES];
-int max[MAX_PROCESSES][MAX_RESOURCES];
-int need[MAX_PROCESSES][MAX_RESOURCES];
-int available[MAX_RESOURCES];
+    bs->available = (int *)base;
+    base += row_bytes;
+    bs->work = (int *)base;
+    base += row_bytes;
+    bs->request = (int *)base;
+    base += row_bytes;
+    bs->max = (int *)base;
+    base += matrix_bytes;
+    bs->allocation = (int *)base;
+    base += matrix_bytes;
+    bs->need = (int *)base;
+    base += matrix_bytes;
+    bs->requested = (int *)base;
+    base += matrix_bytes;
+    bs->need_order = (int *)base;
+    base += queue_bytes;
+    bs->need_keys = (int *)base;
+    base += queue_bytes;
+    bs->need_rank = (int *)base;
+    base += queue_bytes;
+    bs->satisfied_count = (int *)base;
+    base += process_bytes;
+    bs->satisfied_epoch = (unsigned int *)base;
+    base += process_bytes;
+    bs->target_epoch = (unsigned int *)base;
+    base += process_bytes;
+    bs->ready = (int *)base;
+    base += process_bytes;
+    bs->safe_sequence = (int *)base;
+    base += process_bytes;
+    bs->sequence_scratch = (int *)base;
+    base += process_bytes;
+    bs->cursor = (int *)base;
+
+    return bs;
+}
+
+// Function to free a Banker state
+void destroy_banker_state(BankerState *bs)
+{
+    if (bs == NULL)
+    {
+        return;
+    }
+
+    // The available vector is the start of the shared allocation
+    free(bs->available);
+    free(bs->batch_rows);
+    free(bs->batch_order);
+    free(bs->batch_candidates);
+    free(bs->batch_targets);
+    free(bs);
+}
 
 // Function to input system resources and allocation
-void input_resource_data()
+BankerState *input_resource_data()
 {
+    int n, m;
+
     printf("Enter the number of processes: ");
-    scanf("%d", &num_processes);
+    scanf("%d", &n);
 
     printf("Enter the number of resources: ");
-    scanf("%d", &num_resources);
+    scanf("%d", &m);
+
+    BankerState *bs = create_banker_state(n, m);
+    if (bs == NULL)
+    {
+        printf("Error: Invalid or too large system size!\n");
+        return NULL;
+    }
 
     // Input Available Resources
     printf("Enter the number of available resources for each resource type:\n");
-    for (int i = 0; i < num_resources; i++)
+    for (int i = 0; i < m; i++)
     {
         printf("Resource %d: ", i + 1);
-        scanf("%d", &available[i]);
+        scanf("%d", &bs->available[i]);
     }
 
     // Input Maximum Resource Needs
     printf("\nEnter Maximum Resource Need Matrix:\n");
-    for (int i = 0; i < num_processes; i++)
+    for (int i = 0; i < n; i++)
     {
+        int *max_i = BANKER_ROW(bs, max, i);
         printf("Process %d:\n", i + 1);
-        for (int j = 0; j < num_resources; j++)
+        for (int j = 0; j < m; j++)
         {
             printf("  Resource %d max: ", j + 1);
-            scanf("%d", &max[i][j]);
+            scanf("%d", &max_i[j]);
         }
     }
 
     // Input Current Allocation
     printf("\nEnter Current Allocation Matrix:\n");
-    for (int i = 0; i < num_processes; i++)
+    for (int i = 0; i < n; i++)
     {
+        int *allocation_i = BANKER_ROW(bs, allocation, i);
         printf("Process %d:\n", i + 1);
-        for (int j = 0; j < num_resources; j++)
+        for (int j = 0; j < m; j++)
         {
             printf("  Resource %d allocated: ", j + 1);
-            scanf("%d", &allocation[i][j]);
+            scanf("%d", &allocation_i[j]);
         }
     }
 
     // Calculate Need Matrix
     printf("\nCalculating Need Matrix...\n");
-    for (int i = 0; i < num_processes; i++)
+    for (int i = 0; i < n; i++)
     {
-        for (int j = 0; j < num_resources; j++)
+        int *max_i = BANKER_ROW(bs, max, i);
+        int *allocation_i = BANKER_ROW(bs, allocation, i);
+        int *need_i = BANKER_ROW(bs, need, i);
+        for (int j = 0; j < m; j++)
         {
-            need[i][j] = max[i][j] - allocation[i][j];
+            need_i[j] = max_i[j] - allocation_i[j];
         }
     }
+
+    return bs;
 }
 
-// Function to display matrices
-void display_matrices()
+// Print one matrix of the state
+static void display_matrix(const BankerState *bs, const int *matrix)
 {
-    int i, j;
-
-    // Allocation Matrix
-    printf("\nAllocation Matrix:\n");
-    for (i = 0; i < num_processes; i++)
+    for (int i = 0; i < bs->num_processes; i++)
     {
-        for (j = 0; j < num_resources; j++)
+        const int *row = matrix + (size_t)i * bs->stride;
+        for (int j = 0; j < bs->num_resources; j++)
         {
-            printf("%d ", allocation[i][j]);
+            printf("%d ", row[j]);
         }
         printf("\n");
     }
+}
+
+// Function to display matrices
+void display_matrices(const BankerState *bs)
+{
+    // Allocation Matrix
+    printf("\nAllocation Matrix:\n");
+    display_matrix(bs, bs->allocation);
 
     // Max Matrix
     printf("\nMax Matrix:\n");
-    for (i = 0; i < num_processes; i++)
-    {
-        for (j = 0; j < num_resources; j++)
-        {
-            printf("%d ", max[i][j]);
-        }
-        printf("\n");
-    }
+    display_matrix(bs, bs->max);
 
     // Need Matrix
     printf("\nNeed Matrix:\n");
-    for (i = 0; i < num_processes; i++)
-    {
-        for (j = 0; j < num_resources; j++)
-        {
-            printf("%d ", need[i][j]);
-        }
-        printf("\n");
-    }
+    display_matrix(bs, bs->need);
 
     // Available Resources
     printf("\nAvailable Resources:\n");
-    for (j = 0; j < num_resources; j++)
+    for (int j = 0; j < bs->num_resources; j++)
     {
-        printf("%d ", available[j]);
+        printf("%d ", bs->available[j]);
     }
     printf("\n");
 }
 
-// Safety Algorithm to check if system is in safe state
-bool is_safe_state()
+// State snapshots
+// Binary layout, native byte order: a SnapshotHeader followed by int32
+// available[m], max[n * m] and allocation[n * m]. The CSV form holds the
+// same numbers in the same order (n and m first); separators and line
+// breaks are interchangeable and lines starting with '#' are comments.
+#define SNAPSHOT_MAGIC "BNKR"
+#define SNAPSHOT_VERSION 1
+
+typedef struct SnapshotHeader
 {
-    int work[MAX_RESOURCES];
-    bool finish[MAX_PROCESSES] = {false};
-    int safe_sequence[MAX_PROCESSES];
-    int count = 0;
+    char magic[4];
+    uint32_t version;
+    uint32_t num_processes;
+    uint32_t num_resources;
+} SnapshotHeader;
 
-    // Initialize work with available resources
-    for (int i = 0; i < num_resources; i++)
+// Read-only mapping of a whole file
+typedef struct MappedFile
+{
+    const char *data;
+    size_t size;
+} MappedFile;
+
+static bool map_file(const char *path, MappedFile *file)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
     {
-        work[i] = available[i];
+        return false;
     }
 
-    // Find a safe sequence
-    while (count < num_processes)
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
     {
-        bool found = false;
+        close(fd);
+        return false;
+    }
 
-        for (int i = 0; i < num_processes; i++)
-        {
-            // Check if process is not finished
-            if (!finish[i])
-            {
-                bool can_allocate = true;
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
 
-                // Check if need is less than or equal to work
-                for (int j = 0; j < num_resources; j++)
-                {
-                    if (need[i][j] > work[j])
-                    {
-                        can_allocate = false;
-                        break;
-                    }
-                }
+    file->data = data;
+    file->size = st.st_size;
+    return true;
+}
 
-                // If can allocate, add to safe sequence
-                if (can_allocate)
-                {
-                    // Add resources back to work
-                    for (int j = 0; j < num_resources; j++)
-                    {
-                        work[j] += allocation[i][j];
-                    }
+static void unmap_file(MappedFile *file)
+{
+    munmap((void *)file->data, file->size);
+}
 
-                    // Mark process as finished
-                    finish[i] = true;
-                    safe_sequence[count++] = i;
-                    found = true;
-                }
-            }
-        }
+// Derive need from max and allocation; false if some allocation exceeds max
+static bool compute_need_matrix(BankerState *bs)
+{
+    for (int i = 0; i < bs->num_processes; i++)
+    {
+        int *need_i = BANKER_ROW(bs, need, i);
+        const int *allocation_i = BANKER_ROW(bs, allocation, i);
 
-        // If no process can be allocated, system is in unsafe state
-        if (!found)
+        if (!row_less_equal(allocation_i, BANKER_ROW(bs, max, i), bs->stride))
         {
             return false;
         }
+        memcpy(need_i, BANKER_ROW(bs, max, i), sizeof(int) * bs->stride);
+        row_sub(need_i, allocation_i, bs->stride);
     }
+    return true;
+}
 
-    // Print safe sequence
-    printf("\nSafe Sequence: ");
-    for (int i = 0; i < num_processes; i++)
+// Copy n packed rows of m ints from a snapshot into a padded matrix
+static void copy_packed_rows(const BankerState *bs, int *matrix, const int32_t *rows)
+{
+    for (int i = 0; i < bs->num_processes; i++)
     {
-        printf("P%d ", safe_sequence[i]);
+        memcpy(matrix + (size_t)i * bs->stride, rows + (size_t)i * bs->num_resources,
+               sizeof(int32_t) * bs->num_resources);
     }
-    printf("\n");
-
-    return true;
 }
 
-// Request resource function
-bool request_resources(int process_num, int request[])
+// Check that the first m values of each row are not negative
+static bool all_non_negative(const BankerState *bs, const int *matrix, int rows)
 {
-    // Check if request exceeds need
-    for (int i = 0; i < num_resources; i++)
+    for (int i = 0; i < rows; i++)
     {
-        if (request[i] > need[process_num][i])
+        const int *row = matrix + (size_t)i * bs->stride;
+        for (int j = 0; j < bs->num_resources; j++)
         {
-            printf("Error: Request exceeds process's maximum need!\n");
-            return false;
+            if (row[j] < 0)
+            {
+                return false;
+            }
         }
     }
+    return true;
+}
 
-    // Check if request exceeds available
-    for (int i = 0; i < num_resources; i++)
+// Check that available plus all that is allocated fits in an int for
+// every resource, the most the work vector of a safety check can hold;
+// allocation must already be known not to be negative
+static bool totals_fit(BankerState *bs)
+{
+    int *total = bs->work;
+    memcpy(total, bs->available, sizeof(int) * bs->num_resources);
+    for (int i = 0; i < bs->num_processes; i++)
     {
-        if (request[i] > available[i])
+        const int *allocation_i = BANKER_ROW(bs, allocation, i);
+        for (int j = 0; j < bs->num_resources; j++)
         {
-            printf("Error: Insufficient resources available!\n");
-            return false;
+            if (allocation_i[j] > INT32_MAX - total[j])
+            {
+                return false;
+            }
+            total[j] += allocation_i[j];
         }
     }
+    return true;
+}
+
+static BankerState *load_binary_snapshot(const MappedFile *file)
+{
+    SnapshotHeader header;
+    memcpy(&header, file->data, sizeof(header));
+
+    if (header.version != SNAPSHOT_VERSION || header.num_processes == 0 ||
+        header.num_resources == 0 || header.num_processes > INT32_MAX ||
+        header.num_resources > INT32_MAX)
+    {
+        return NULL;
+    }
 
-    // Simulate allocation
-    for (int i = 0; i < num_resources; i++)
+    // Bound both dimensions by the file size before multiplying them, so a
+    // crafted header cannot wrap the expected size around to a match
+    size_t n = header.num_processes;
+    size_t m = header.num_resources;
+    size_t value_count = (file->size - sizeof(header)) / sizeof(int32_t);
+    if (m > value_count || n > (value_count - m) / 2 / m)
+    {
+        return NULL;
+    }
+    size_t expected = sizeof(header) + sizeof(int32_t) * (m + 2 * n * m);
+    if (file->size != expected)
     {
-        available[i] -= request[i];
-        allocation[process_num][i] += request[i];
-        need[process_num][i] -= request[i];
+        return NULL;
     }
 
-    // Check if the system remains in a safe state
-    if (is_safe_state())
+    BankerState *bs = create_banker_state(n, m);
+    if (bs == NULL)
     {
-        printf("Resource request for Process P%d is granted.\n", process_num);
-        return true;
+        return NULL;
     }
-    else
+
+    const int32_t *values = (const int32_t *)(file->data + sizeof(header));
+    memcpy(bs->available, values, sizeof(int32_t) * m);
+    copy_packed_rows(bs, bs->max, values + m);
+    copy_packed_rows(bs, bs->allocation, values + m + n * m);
+
+    if (!all_non_negative(bs, bs->available, 1) ||
+        !all_non_negative(bs, bs->max, n) ||
+        !all_non_negative(bs, bs->allocation, n) ||
+        !totals_fit(bs) ||
+        !compute_need_matrix(bs))
     {
-        // Rollback if system becomes unsafe
-        for (int i = 0; i < num_resources; i++)
+        destroy_banker_state(bs);
+        return NULL;
+    }
+    return bs;
+}
+
+// Skip separators and comment lines of a CSV snapshot
+static const char *skip_separators(const char *c, const char *end)
+{
+    while (c < end)
+    {
+        if (*c == '#')
         {
-            available[i] += request[i];
-            allocation[process_num][i] -= request[i];
-            need[process_num][i] += request[i];
+            while (c < end && *c != '\n')
+            {
+                c++;
+            }
+        }
+        else if (*c == ',' || *c == ' ' || *c == '\t' || *c == '\r' || *c == '\n')
+        {
+            c++;
+        }
+        else
+        {
+            break;
         }
-        printf("Resource request for Process P%d is denied to prevent potential deadlock.\n", process_num);
-        return false;
     }
+    return c;
 }
 
-// Main function
-int main()
+// Next integer of a CSV snapshot; false at end of input or on bad syntax
+static bool parse_next_int(const char **cursor, const char *end, int *value)
 {
-    // Input resource data
-    input_resource_data();
+    const char *c = skip_separators(*cursor, end);
 
-    // Display input matrices
-    display_matrices();
+    bool negative = false;
+    if (c < end && *c == '-')
+    {
+        negative = true;
+        c++;
+    }
+    if (c >= end || *c < '0' || *c > '9')
+    {
+        return false;
+    }
 
-    // Check initial system state
-    printf("\nChecking Initial System State:\n");
-    if (is_safe_state())
+    long result = 0;
+    while (c < end && *c >= '0' && *c <= '9')
     {
-        printf("Initial system state is SAFE.\n");
+        result = result * 10 + (*c++ - '0');
+        if (result > INT32_MAX)
+        {
+            return false;
+        }
     }
-    else
+
+    *value = negative ? (int)-result : (int)result;
+    *cursor = c;
+    return true;
+}
+
+// Parse m values per row for every process row of a padded matrix
+static bool parse_rows(const BankerState *bs, int *matrix, int rows,
+                       const char **cursor, const char *end)
+{
+    for (int i = 0; i < rows; i++)
     {
-        printf("Initial system state is UNSAFE.\n");
+        int *row = matrix + (size_t)i * bs->stride;
+        for (int j = 0; j < bs->num_resources; j++)
+        {
+            if (!parse_next_int(cursor, end, &row[j]))
+            {
+                return false;
+            }
+        }
     }
+    return true;
+}
 
-    // Demonstration of resource request
-    int example_request[MAX_RESOURCES];
-    printf("\nDemonstrating Resource Request:\n");
-    printf("Enter a process number (0 to %d): ", num_processes - 1);
-    int process_num;
-    scanf("%d", &process_num);
+static BankerState *load_csv_snapshot(const MappedFile *file)
+{
+    const char *cursor = file->data;
+    const char *end = file->data + file->size;
+    int n, m;
 
-    printf("Enter resource request for Process P%d:\n", process_num);
-    for (int i = 0; i < num_resources; i++)
+    if (!parse_next_int(&cursor, end, &n) || !parse_next_int(&cursor, end, &m))
     {
-        printf("  Resource %d request: ", i + 1);
-        scanf("%d", &example_request[i]);
+        return NULL;
     }
 
-    // Request resources
-    request_resources(process_num, example_request);
+    // Every value still to come takes a separator and a digit, so bound
+    // both dimensions by the rest of the file before allocating
+    long long values = (end - cursor) / 2;
+    if (n <= 0 || m <= 0 || m > values || n > (values - m) / (m + 1))
+    {
+        return NULL;
+    }
 
-    return 0;
-}
\ No newline at end of file
+    BankerState *bs = create_banker_state(n, m);
+    if (bs == NULL)
+    {
+        return NULL;
+    }
+
+    if (!parse_rows(bs, bs->available, 1, &cursor, end) ||
+        !parse_rows(bs, bs->max, n, &cursor, end) ||
+        !parse_rows(bs, bs->allocation, n, &cursor, end) ||
+        skip_separators(cursor, end) != end ||
+        !all_non_negative(bs, bs->available, 1) ||
+        !all_non_negative(bs, bs->max, n) ||
+        !all_non_negative(bs, bs->allocation, n) ||
+        !totals_fit(bs) ||
+        !compute_need_matrix(bs))
+    {
+        destroy_banker_state(bs);
+        return NULL;
+    }
+    return bs;
+}
+
+// Function to load a binary or CSV snapshot; the format is detected from
+// the file contents. Returns NULL if the file is missing or malformed.
+BankerState *load_banker_snapshot(const char *path)
+{
+    MappedFile file;
+    if (!map_file(path, &file))
+    {
+        return NULL;
+    }
+
+    BankerState *bs;
+    if (file.size >= sizeof(SnapshotHeader) &&
+        memcmp(file.data, SNAPSHOT_MAGIC, 4) == 0)
+    {
+        bs = load_binary_snapshot(&file);
+    }
+    else
+    {
+        bs = load_csv_snapshot(&file);
+    }
+
+    unmap_file(&file);
+    return bs;
+}
+
+// Write n rows of a padded matrix without the padding
+static bool write_packed_rows(const BankerState *bs, const int *matrix, int rows, FILE *out)
+{
+    for (int i = 0; i < rows; i++)
+    {
+        if (fwrite(matrix + (size_t)i * bs->stride, sizeof(int32_t),
+                   bs->num_resources, out) != (size_t)bs->num_resources)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Function to write a binary snapshot
+bool save_banker_snapshot(const BankerState *bs, const char *path)
+{
+    FILE *out = fopen(path, "wb");
+    if (out == NULL)
+    {
+        return false;
+    }
+
+    SnapshotHeader header = {.version = SNAPSHOT_VERSION,
+                             .num_processes = bs->num_processes,
+                             .num_resources = bs->num_resources};
+    memcpy(header.magic, SNAPSHOT_MAGIC, 4);
+
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+              write_packed_rows(bs, bs->available, 1, out) &&
+              write_packed_rows(bs, bs->max, bs->num_processes, out) &&
+              write_packed_rows(bs, bs->allocation, bs->num_processes, out);
+
+    return fclose(out) == 0 && ok;
+}
+
+// Write n rows of a padded matrix as CSV lines
+static void write_csv_rows(const BankerState *bs, const int *matrix, int rows, FILE *out)
+{
+    for (int i = 0; i < rows; i++)
+    {
+        const int *row = matrix + (size_t)i * bs->stride;
+        for (int j = 0; j < bs->num_resources; j++)
+        {
+            fprintf(out, j == 0 ? "%d" : ",%d", row[j]);
+        }
+        fputc('\n', out);
+    }
+}
+
+// Function to write a CSV snapshot
+bool save_banker_csv(const BankerState *bs, const char *path)
+{
+    FILE *out = fopen(path, "w");
+    if (out == NULL)
+    {
+        return false;
+    }
+
+    fprintf(out, "# processes,resources\n%d,%d\n", bs->num_processes, bs->num_resources);
+    fprintf(out, "# available\n");
+    write_csv_rows(bs, bs->available, 1, out);
+    fprintf(out, "# max\n");
+    write_csv_rows(bs, bs->max, bs->num_processes, out);
+    fprintf(out, "# allocation\n");
+    write_csv_rows(bs, bs->allocation, bs->num_processes, out);
+
+    return fclose(out) == 0;
+}
+
+// Reference safety algorithm, without output: repeatedly finish any
+// process whose need fits in work. Fills safe_sequence (n entries) when
+// it is not NULL and the state is safe.
+static bool reference_safe_check(const BankerState *bs, int safe_sequence[])
+{
+    int n = bs->num_processes;
+    int stride = bs->stride;
+    int *work = malloc(sizeof(int) * stride);
+    bool *finish = calloc(n, sizeof(bool));
+    int count = 0;
+    bool safe = true;
+
+    // Initialize work with available resources
+    memcpy(work, bs->available, sizeof(int) * stride);
+
+    // Find a safe sequence
+    while (count < n)
+    {
+        bool found = false;
+
+        for (int i = 0; i < n; i++)
+        {
+            // Check if process is not finished
+            if (!finish[i])
+            {
+                // Check if need is less than or equal to work
+                bool can_allocate = row_less_equal(BANKER_ROW(bs, need, i), work, stride);
+
+                // If can allocate, add to safe sequence
+                if (can_allocate)
+                {
+                    // Add resources back to work
+                    row_add(work, BANKER_ROW(bs, allocation, i), stride);
+
+                    // Mark process as finished
+                    finish[i] = true;
+                    if (safe_sequence != NULL)
+                    {
+                        safe_sequence[count] = i;
+                    }
+                    count++;
+                    found = true;
+                }
+            }
+        }
+
+        // If no process can be allocated, system is in unsafe state
+        if (!found)
+        {
+            safe = false;
+            break;
+        }
+    }
+
+    free(work);
+    free(finish);
+    return safe;
+}
+
+// Safety Algorithm to check if system is in safe state
+bool is_safe_state(const BankerState *bs)
+{
+    int n = bs->num_processes;
+    int *safe_sequence = malloc(sizeof(int) * n);
+    bool safe = reference_safe_check(bs, safe_sequence);
+
+    // Print safe sequence
+    if (safe)
+    {
+        printf("\nSafe Sequence: ");
+        for (int i = 0; i < n; i++)
+        {
+            printf("P%d ", safe_sequence[i]);
+        }
+        printf("\n");
+    }
+
+    free(safe_sequence);
+    return safe;
+}
+
+// Sort entry used while building the need queues
+typedef struct NeedEntry
+{
+    int key;
+    int process;
+} NeedEntry;
+
+static int compare_need_entries(const void *a, const void *b)
+{
+    const NeedEntry *x = a;
+    const NeedEntry *y = b;
+
+    if (x->key != y->key)
+    {
+        return x->key < y->key ? -1 : 1;
+    }
+    return x->process - y->process;
+}
+
+// Rebuild the per-resource sorted need queues from the need matrix
+void build_need_queues(BankerState *bs)
+{
+    int n = bs->num_processes;
+    NeedEntry *entries = malloc(sizeof(NeedEntry) * n);
+
+    for (int j = 0; j < bs->num_resources; j++)
+    {
+        int *order = bs->need_order + (size_t)j * n;
+        int *keys = bs->need_keys + (size_t)j * n;
+        int *rank = bs->need_rank + (size_t)j * n;
+
+        for (int i = 0; i < n; i++)
+        {
+            entries[i].key = BANKER_ROW(bs, need, i)[j];
+            entries[i].process = i;
+        }
+        qsort(entries, n, sizeof(NeedEntry), compare_need_entries);
+
+        for (int k = 0; k < n; k++)
+        {
+            order[k] = entries[k].process;
+            keys[k] = entries[k].key;
+            rank[entries[k].process] = k;
+        }
+    }
+
+    free(entries);
+}
+
+// Move process p back into sorted position after its need on resource j changed
+void update_need_rank(BankerState *bs, int p, int j)
+{
+    int n = bs->num_processes;
+    int *order = bs->need_order + (size_t)j * n;
+    int *keys = bs->need_keys + (size_t)j * n;
+    int *rank = bs->need_rank + (size_t)j * n;
+    int key = BANKER_ROW(bs, need, p)[j];
+    int pos = rank[p];
+
+    // Need shrank: move towards the front one run of equal keys at a time,
+    // swapping the first process of the run into the hole left by p
+    while (pos > 0 && keys[pos - 1] > key)
+    {
+        int run_key = keys[pos - 1];
+        int lo = 0, hi = pos - 1;
+        while (lo < hi)
+        {
+            int mid = lo + (hi - lo) / 2;
+            if (keys[mid] < run_key)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        order[pos] = order[lo];
+        keys[pos] = run_key;
+        rank[order[pos]] = pos;
+        pos = lo;
+    }
+
+    // Need grew: move towards the back the same way, using the last process
+    // of each run
+    while (pos < n - 1 && keys[pos + 1] < key)
+    {
+        int run_key = keys[pos + 1];
+        int lo = pos + 1, hi = n - 1;
+        while (lo < hi)
+        {
+            int mid = lo + (hi - lo + 1) / 2;
+            if (keys[mid] > run_key)
+            {
+                hi = mid - 1;
+            }
+            else
+            {
+                lo = mid;
+            }
+        }
+        order[pos] = order[lo];
+        keys[pos] = run_key;
+        rank[order[pos]] = pos;
+        pos = lo;
+    }
+
+    order[pos] = p;
+    keys[pos] = key;
+    rank[p] = pos;
+}
+
+// Advance the cursor of resource j over every process whose need now fits in
+// work[j]; processes satisfied on all resources are pushed on the ready stack
+static void advance_need_cursor(BankerState *bs, int j, int *ready_top)
+{
+    int n = bs->num_processes;
+    const int *order = bs->need_order + (size_t)j * n;
+    const int *keys = bs->need_keys + (size_t)j * n;
+    int cursor = bs->cursor[j];
+    int limit = bs->work[j];
+
+    while (cursor < n && keys[cursor] <= limit)
+    {
+        int i = order[cursor++];
+
+        if (bs->satisfied_epoch[i] != bs->check_epoch)
+        {
+            bs->satisfied_epoch[i] = bs->check_epoch;
+            bs->satisfied_count[i] = 0;
+        }
+
+        if (++bs->satisfied_count[i] == bs->num_resources)
+        {
+            bs->ready[(*ready_top)++] = i;
+        }
+    }
+
+    bs->cursor[j] = cursor;
+}
+
+// Start a new check epoch, clearing the stamps only when the counter wraps
+static void start_check_epoch(BankerState *bs)
+{
+    if (++bs->check_epoch == 0)
+    {
+        memset(bs->satisfied_epoch, 0, sizeof(unsigned int) * bs->num_processes);
+        memset(bs->target_epoch, 0, sizeof(unsigned int) * bs->num_processes);
+        bs->check_epoch = 1;
+    }
+}
+
+// Make the `count` processes in sequence_scratch the head of the cached
+// safe sequence, followed by the other processes in their cached order.
+// If those processes can finish first, the rest still can in the old order
+// because by then work is at least what it was at the same point before.
+static void promote_to_sequence_head(BankerState *bs, int count)
+{
+    int n = bs->num_processes;
+    int *head = bs->sequence_scratch;
+
+    // A single process just moves to the front
+    if (count == 1)
+    {
+        int p = head[0];
+        int pos = 0;
+        while (bs->safe_sequence[pos] != p)
+        {
+            pos++;
+        }
+        memmove(bs->safe_sequence + 1, bs->safe_sequence, sizeof(int) * pos);
+        bs->safe_sequence[0] = p;
+        return;
+    }
+
+    start_check_epoch(bs);
+    for (int k = 0; k < count; k++)
+    {
+        bs->satisfied_epoch[head[k]] = bs->check_epoch;
+    }
+    for (int k = 0; k < n; k++)
+    {
+        int i = bs->safe_sequence[k];
+        if (bs->satisfied_epoch[i] != bs->check_epoch)
+        {
+            head[count++] = i;
+        }
+    }
+
+    bs->sequence_scratch = bs->safe_sequence;
+    bs->safe_sequence = head;
+}
+
+// Incremental safety check
+// If the state before a set of grants was safe, the new state is safe as
+// soon as every process that received a grant can finish, so the check
+// stops there; with no targets the check runs over every process. It tries,
+// in order: the targets alone, a replay of the cached safe sequence, and
+// the queue engine, which only examines processes whose limiting resource
+// became satisfiable.
+bool incremental_safe_check_targets(BankerState *bs, const int targets[], int num_targets)
+{
+    int m = bs->num_resources;
+    int ready_top = 0;
+    int finished = 0;
+    int remaining = 0;
+
+    start_check_epoch(bs);
+
+    // Count each target process once
+    for (int k = 0; k < num_targets; k++)
+    {
+        if (bs->target_epoch[targets[k]] != bs->check_epoch)
+        {
+            bs->target_epoch[targets[k]] = bs->check_epoch;
+            remaining++;
+        }
+    }
+
+    // Fast path: one pass over the targets alone, finishing each one whose
+    // need already fits; if they all finish no other process matters
+    if (num_targets > 0)
+    {
+        int done = 0;
+        memcpy(bs->work, bs->available, sizeof(int) * bs->stride);
+        for (int k = 0; k < num_targets; k++)
+        {
+            int t = targets[k];
+            if (bs->satisfied_epoch[t] == bs->check_epoch)
+            {
+                continue; // Duplicate target, already finished
+            }
+            if (!row_less_equal(BANKER_ROW(bs, need, t), bs->work, bs->stride))
+            {
+                break;
+            }
+            row_add(bs->work, BANKER_ROW(bs, allocation, t), bs->stride);
+            bs->satisfied_epoch[t] = bs->check_epoch;
+            bs->sequence_scratch[done++] = t;
+        }
+        if (done == remaining)
+        {
+            if (bs->sequence_valid)
+            {
+                promote_to_sequence_head(bs, done);
+            }
+            return true;
+        }
+
+        // Replay the cached sequence, deferring processes that cannot
+        // finish yet and retrying those once at the end
+        if (bs->sequence_valid)
+        {
+            int left = remaining;
+            int deferred = 0;
+            done = 0;
+            memcpy(bs->work, bs->available, sizeof(int) * bs->stride);
+            for (int k = 0; k < bs->num_processes + deferred; k++)
+            {
+                int i = k < bs->num_processes ? bs->safe_sequence[k] : bs->ready[k - bs->num_processes];
+                if (!row_less_equal(BANKER_ROW(bs, need, i), bs->work, bs->stride))
+                {
+                    if (k < bs->num_processes)
+                    {
+                        bs->ready[deferred++] = i;
+                    }
+                    continue;
+                }
+                row_add(bs->work, BANKER_ROW(bs, allocation, i), bs->stride);
+                bs->sequence_scratch[done++] = i;
+                if (bs->target_epoch[i] == bs->check_epoch && --left == 0)
+                {
+                    // Without deferrals the cached order itself was replayed
+                    if (deferred > 0)
+                    {
+                        promote_to_sequence_head(bs, done);
+                    }
+                    return true;
+                }
+            }
+        }
+
+        // Fall back to the full engine with fresh counters
+        start_check_epoch(bs);
+        for (int k = 0; k < num_targets; k++)
+        {
+            bs->target_epoch[targets[k]] = bs->check_epoch;
+        }
+    }
+
+    // Admit every (process, resource) pair already covered by available
+    for (int j = 0; j < m; j++)
+    {
+        bs->work[j] = bs->available[j];
+        bs->cursor[j] = 0;
+    }
+    for (int j = 0; j < m; j++)
+    {
+        advance_need_cursor(bs, j, &ready_top);
+    }
+
+    // Finish ready processes and release their allocation
+    while (ready_top > 0)
+    {
+        int i = bs->ready[--ready_top];
+        const int *allocation_i = BANKER_ROW(bs, allocation, i);
+        bs->sequence_scratch[finished++] = i;
+
+        if (bs->target_epoch[i] == bs->check_epoch && --remaining == 0)
+        {
+            if (bs->sequence_valid)
+            {
+                promote_to_sequence_head(bs, finished);
+            }
+            return true;
+        }
+
+        for (int j = 0; j < m; j++)
+        {
+            if (allocation_i[j] > 0)
+            {
+                bs->work[j] += allocation_i[j];
+                advance_need_cursor(bs, j, &ready_top);
+            }
+        }
+    }
+
+    // A complete run is itself a safe sequence
+    if (finished == bs->num_processes)
+    {
+        int *sequence = bs->safe_sequence;
+        bs->safe_sequence = bs->sequence_scratch;
+        bs->sequence_scratch = sequence;
+        bs->sequence_valid = true;
+        return true;
+    }
+    return false;
+}
+
+// Incremental safety check for a single grant to `requester`; pass -1 to
+// run the check over every process
+bool incremental_safe_check(BankerState *bs, int requester)
+{
+    if (requester < 0)
+    {
+        return incremental_safe_check_targets(bs, NULL, 0);
+    }
+    return incremental_safe_check_targets(bs, &requester, 1);
+}
+
+// Build the engine queues and establish whether the current state is safe
+void initialize_safety_engine(BankerState *bs)
+{
+    build_need_queues(bs);
+    bs->known_safe = incremental_safe_check(bs, -1);
+}
+
+// Outcome of a resource request
+typedef enum BankerVerdict
+{
+    BANKER_GRANTED,
+    BANKER_INVALID_PROCESS,
+    BANKER_EXCEEDS_NEED,
+    BANKER_INSUFFICIENT,
+    BANKER_UNSAFE,
+    BANKER_EXCEEDS_ALLOCATION,
+    BANKER_ABORTED,  // Waiting request cancelled to break a deadlock
+    BANKER_NO_MEMORY // Scratch space for the operation could not be allocated
+} BankerVerdict;
+
+// One entry of a batched admission
+typedef struct BankerRequest
+{
+    int process;        // Requesting process
+    const int *request; // num_resources requested units
+} BankerRequest;
+
+// Move a padded request row from available to process p
+static void apply_grant(BankerState *bs, int p, const int *padded)
+{
+    row_sub(bs->available, padded, bs->stride);
+    row_add(BANKER_ROW(bs, allocation, p), padded, bs->stride);
+    row_sub(BANKER_ROW(bs, need, p), padded, bs->stride);
+    for (int j = 0; j < bs->num_resources; j++)
+    {
+        if (padded[j] != 0)
+        {
+            update_need_rank(bs, p, j);
+        }
+    }
+}
+
+// Undo apply_grant
+static void revoke_grant(BankerState *bs, int p, const int *padded)
+{
+    row_add(bs->available, padded, bs->stride);
+    row_sub(BANKER_ROW(bs, allocation, p), padded, bs->stride);
+    row_add(BANKER_ROW(bs, need, p), padded, bs->stride);
+    for (int j = 0; j < bs->num_resources; j++)
+    {
+        if (padded[j] != 0)
+        {
+            update_need_rank(bs, p, j);
+        }
+    }
+}
+
+// Validate a padded request row against need and available
+static BankerVerdict check_request_bounds(const BankerState *bs, int p, const int *padded)
+{
+    if (p < 0 || p >= bs->num_processes)
+    {
+        return BANKER_INVALID_PROCESS;
+    }
+    if (!row_less_equal(padded, BANKER_ROW(bs, need, p), bs->stride))
+    {
+        return BANKER_EXCEEDS_NEED;
+    }
+    if (!row_less_equal(padded, bs->available, bs->stride))
+    {
+        return BANKER_INSUFFICIENT;
+    }
+    return BANKER_GRANTED;
+}
+
+// Grant a padded request row if the system stays safe (no output)
+static BankerVerdict try_grant(BankerState *bs, int p, const int *padded)
+{
+    BankerVerdict verdict = check_request_bounds(bs, p, padded);
+    if (verdict != BANKER_GRANTED)
+    {
+        return verdict;
+    }
+
+    // Simulate allocation
+    apply_grant(bs, p, padded);
+
+    // Check if the system remains in a safe state, stopping early once the
+    // requester can finish when the previous state is known to be safe
+    bool safe = incremental_safe_check(bs, bs->known_safe ? p : -1);
+
+#ifdef BANKER_VERIFY
+    // Cross-check the incremental engine against the reference algorithm
+    assert(safe == reference_safe_check(bs, NULL));
+#endif
+
+    if (!safe)
+    {
+        // Rollback if system becomes unsafe
+        revoke_grant(bs, p, padded);
+        return BANKER_UNSAFE;
+    }
+
+    bs->known_safe = true;
+    return BANKER_GRANTED;
+}
+
+// Request resource function
+bool request_resources(BankerState *bs, int process_num, int request[])
+{
+    // Copy the request into a zero-padded row for the kernels
+    memcpy(bs->request, request, sizeof(int) * bs->num_resources);
+
+    switch (try_grant(bs, process_num, bs->request))
+    {
+    case BANKER_GRANTED:
+        printf("Resource request for Process P%d is granted.\n", process_num);
+        return true;
+    case BANKER_INVALID_PROCESS:
+        printf("Error: Invalid process number!\n");
+        return false;
+    case BANKER_EXCEEDS_NEED:
+        printf("Error: Request exceeds process's maximum need!\n");
+        return false;
+    case BANKER_INSUFFICIENT:
+        printf("Error: Insufficient resources available!\n");
+        return false;
+    default:
+        printf("Resource request for Process P%d is denied to prevent potential deadlock.\n", process_num);
+        return false;
+    }
+}
+
+// Return units held by process p (no output)
+static BankerVerdict try_release(BankerState *bs, int p, const int *padded)
+{
+    if (p < 0 || p >= bs->num_processes)
+    {
+        return BANKER_INVALID_PROCESS;
+    }
+    if (!row_less_equal(padded, BANKER_ROW(bs, allocation, p), bs->stride))
+    {
+        return BANKER_EXCEEDS_ALLOCATION;
+    }
+
+    // A release is the inverse of a grant and always keeps a safe state safe
+    revoke_grant(bs, p, padded);
+    return BANKER_GRANTED;
+}
+
+// Release resource function
+bool release_resources(BankerState *bs, int process_num, int release[])
+{
+    // Copy the release into a zero-padded row for the kernels
+    memcpy(bs->request, release, sizeof(int) * bs->num_resources);
+
+    switch (try_release(bs, process_num, bs->request))
+    {
+    case BANKER_GRANTED:
+        printf("Resources released by Process P%d.\n", process_num);
+        return true;
+    case BANKER_INVALID_PROCESS:
+        printf("Error: Invalid process number!\n");
+        return false;
+    default:
+        printf("Error: Release exceeds process's current allocation!\n");
+        return false;
+    }
+}
+
+
+typedef struct BatchEntry
+{
+    long total;
+    int index;
+} BatchEntry;
+
+static int compare_batch_entries(const void *a, const void *b)
+{
+    const BatchEntry *x = a;
+    const BatchEntry *y = b;
+
+    if (x->total != y->total)
+    {
+        return x->total < y->total ? -1 : 1;
+    }
+    return x->index - y->index;
+}
+
+// Make room for `count` requests in the batch scratch
+static bool reserve_batch_scratch(BankerState *bs, int count)
+{
+    if (count <= bs->batch_capacity)
+    {
+        return true;
+    }
+
+    int capacity = bs->batch_capacity > 0 ? bs->batch_capacity : 16;
+    while (capacity < count)
+    {
+        capacity *= 2;
+    }
+
+    free(bs->batch_rows);
+    free(bs->batch_order);
+    free(bs->batch_candidates);
+    free(bs->batch_targets);
+    bs->batch_rows = malloc(sizeof(int) * (size_t)capacity * bs->stride);
+    bs->batch_order = malloc(sizeof(BatchEntry) * capacity);
+    bs->batch_candidates = malloc(sizeof(int) * capacity);
+    bs->batch_targets = malloc(sizeof(int) * capacity);
+    bs->batch_capacity = capacity;
+
+    if (bs->batch_rows == NULL || bs->batch_order == NULL ||
+        bs->batch_candidates == NULL || bs->batch_targets == NULL)
+    {
+        bs->batch_capacity = 0;
+        return false;
+    }
+    return true;
+}
+
+// Check the first `prefix` candidates; the state before them is known safe
+// so only their processes have to be able to finish
+static bool batch_prefix_is_safe(BankerState *bs, const BankerRequest requests[],
+                                 const int candidates[], int prefix)
+{
+    for (int k = 0; k < prefix; k++)
+    {
+        bs->batch_targets[k] = requests[candidates[k]].process;
+    }
+    return incremental_safe_check_targets(bs, bs->batch_targets, prefix);
+}
+
+// Grant or revoke batch candidates until exactly `target` of them are applied
+static void set_batch_prefix(BankerState *bs, const BankerRequest requests[],
+                             const int candidates[], const int *rows,
+                             int *applied, int target)
+{
+    while (*applied < target)
+    {
+        int r = candidates[*applied];
+        apply_grant(bs, requests[r].process, rows + (size_t)r * bs->stride);
+        (*applied)++;
+    }
+    while (*applied > target)
+    {
+        (*applied)--;
+        int r = candidates[*applied];
+        revoke_grant(bs, requests[r].process, rows + (size_t)r * bs->stride);
+    }
+}
+
+// Batched admission
+// Requests are considered smallest first. Every request that fits in need
+// and available is applied tentatively and the whole batch is checked once
+// (stopping as soon as every process in the batch can finish);
+// only if that fails is the largest safe prefix located by binary search
+// (safety is monotone in the prefix length) and the remaining candidates
+// retried one by one with the incremental check. Requests that did not fit
+// only because of the candidates given back are then retried as well.
+// verdicts[k] receives the outcome of requests[k] (BANKER_NO_MEMORY for
+// all of them if scratch space cannot be allocated); the number of granted
+// requests is returned.
+int request_resources_batch(BankerState *bs, const BankerRequest requests[],
+                            int count, BankerVerdict verdicts[])
+{
+    int m = bs->num_resources;
+    int stride = bs->stride;
+    int granted = 0;
+
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    if (!reserve_batch_scratch(bs, count))
+    {
+        for (int k = 0; k < count; k++)
+        {
+            verdicts[k] = BANKER_NO_MEMORY;
+        }
+        return 0;
+    }
+
+    int *rows = bs->batch_rows;
+    BatchEntry *order = bs->batch_order;
+    int *candidates = bs->batch_candidates;
+    int num_candidates = 0;
+
+    // Copy every request into a padded row and order them by total size
+    for (int k = 0; k < count; k++)
+    {
+        int *row = rows + (size_t)k * stride;
+        long total = 0;
+
+        memset(row, 0, sizeof(int) * stride);
+        if (requests[k].process >= 0 && requests[k].process < bs->num_processes)
+        {
+            memcpy(row, requests[k].request, sizeof(int) * m);
+            for (int j = 0; j < m; j++)
+            {
+                total += row[j];
+            }
+        }
+        order[k].total = total;
+        order[k].index = k;
+    }
+    qsort(order, count, sizeof(BatchEntry), compare_batch_entries);
+
+    // Make sure the starting state is safe; nothing can be granted otherwise
+    if (!bs->known_safe)
+    {
+        bs->known_safe = incremental_safe_check(bs, -1);
+    }
+
+    // Tentatively apply every request that fits, in size order
+    for (int k = 0; k < count; k++)
+    {
+        int r = order[k].index;
+        const int *row = rows + (size_t)r * stride;
+
+        verdicts[r] = check_request_bounds(bs, requests[r].process, row);
+        if (verdicts[r] != BANKER_GRANTED)
+        {
+            continue;
+        }
+        if (!bs->known_safe)
+        {
+            verdicts[r] = BANKER_UNSAFE;
+            continue;
+        }
+
+        apply_grant(bs, requests[r].process, row);
+        candidates[num_candidates++] = r;
+    }
+
+    int applied = num_candidates;
+    if (num_candidates > 0 && !batch_prefix_is_safe(bs, requests, candidates, num_candidates))
+    {
+        // Largest safe prefix: lo is known safe, hi known unsafe
+        int lo = 0;
+        int hi = num_candidates;
+        while (hi - lo > 1)
+        {
+            int mid = lo + (hi - lo) / 2;
+            set_batch_prefix(bs, requests, candidates, rows, &applied, mid);
+            if (batch_prefix_is_safe(bs, requests, candidates, mid))
+            {
+                lo = mid;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        set_batch_prefix(bs, requests, candidates, rows, &applied, lo);
+
+        // The request that broke the prefix is unsafe; retry the rest alone
+        verdicts[candidates[lo]] = BANKER_UNSAFE;
+        for (int k = lo + 1; k < num_candidates; k++)
+        {
+            int r = candidates[k];
+            verdicts[r] = try_grant(bs, requests[r].process, rows + (size_t)r * stride);
+        }
+
+        // Revoked candidates returned units to available, so requests that
+        // were short while the whole batch was applied may fit now
+        for (int k = 0; k < count; k++)
+        {
+            int r = order[k].index;
+            if (verdicts[r] == BANKER_INSUFFICIENT)
+            {
+                verdicts[r] = try_grant(bs, requests[r].process, rows + (size_t)r * stride);
+            }
+        }
+    }
+
+    for (int k = 0; k < count; k++)
+    {
+        if (verdicts[k] == BANKER_GRANTED)
+        {
+            granted++;
+        }
+    }
+
+#ifdef BANKER_VERIFY
+    // The admitted batch must leave the system safe
+    assert(!bs->known_safe || reference_safe_check(bs, NULL));
+#endif
+
+    return granted;
+}
+
+// True when every entry of a padded row is zero
+static bool row_is_zero(const int *row, int length)
+{
+    for (int k = 0; k < length; k++)
+    {
+        if (row[k] != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Deadlock detection
+// Multi-instance detection over allocation, available and the requested
+// matrix: a process holding nothing cannot be deadlocked, and a process
+// whose outstanding request fits in work is assumed to finish and return
+// its allocation. Whatever remains is deadlocked. Fills deadlocked[] and
+// returns its length.
+int detect_deadlock(BankerState *bs, int deadlocked[])
+{
+    int *active = bs->ready;
+    int num_active = 0;
+    bool progress = true;
+
+    memcpy(bs->work, bs->available, sizeof(int) * bs->stride);
+    for (int i = 0; i < bs->num_processes; i++)
+    {
+        if (!row_is_zero(BANKER_ROW(bs, allocation, i), bs->stride))
+        {
+            active[num_active++] = i;
+        }
+    }
+
+    // Sweep the remaining processes until a sweep frees nothing
+    while (progress && num_active > 0)
+    {
+        int kept = 0;
+        progress = false;
+        for (int k = 0; k < num_active; k++)
+        {
+            int i = active[k];
+            if (row_less_equal(BANKER_ROW(bs, requested, i), bs->work, bs->stride))
+            {
+                row_add(bs->work, BANKER_ROW(bs, allocation, i), bs->stride);
+                progress = true;
+            }
+            else
+            {
+                active[kept++] = i;
+            }
+        }
+        num_active = kept;
+    }
+
+    memcpy(deadlocked, active, sizeof(int) * num_active);
+    return num_active;
+}
+
+// Concurrent resource manager
+// Submitting threads publish operations on a lock-free stack; whichever
+// thread wins the combine lock drains the stack, applies all releases and
+// admits all requests as one batch, then marks each operation done.
+typedef enum BankerOpType
+{
+    BANKER_OP_REQUEST,
+    BANKER_OP_RELEASE
+} BankerOpType;
+
+// Operation published to the combiner; lives on the submitting thread's stack
+typedef struct BankerOp
+{
+    BankerOpType type;
+    int process;
+    const int *units; // num_resources entries
+    BankerVerdict verdict;
+    struct BankerOp *next;
+    atomic_int done;
+} BankerOp;
+
+// Request parked until resources are released; lives on the waiting
+// thread's stack and is signalled through its own condition variable
+typedef struct BankerWaiter
+{
+    int process;
+    const int *units; // num_resources entries
+    BankerVerdict verdict;
+    bool woken;
+    int list; // Index of the wait list holding this waiter
+    pthread_cond_t wakeup;
+    struct BankerWaiter *next;
+} BankerWaiter;
+
+// FIFO list of waiters
+typedef struct WaitList
+{
+    BankerWaiter *head;
+    BankerWaiter *tail;
+} WaitList;
+
+// How the manager admits requests: avoidance runs the safety check on every
+// grant, detection grants whatever fits and relies on periodic detection
+typedef enum BankerPolicy
+{
+    BANKER_AVOIDANCE,
+    BANKER_DETECTION
+} BankerPolicy;
+
+// Called by the detector with the deadlocked processes
+typedef void (*DeadlockCallback)(const int deadlocked[], int count, void *context);
+
+typedef struct BankerManager
+{
+    BankerState *state;
+    pthread_mutex_t combine_lock; // Held by the thread acting as combiner
+    _Atomic(BankerOp *) pending;  // Published, not yet combined operations
+
+    // Blocked requests: waiting[j] holds waiters short on resource j and
+    // waiting[num_resources] those that only failed the safety check.
+    // released[j] is set when resource j was returned since the last wakeup.
+    WaitList *waiting;
+    bool *released;
+
+    // Deadlock detection; waiter_of[p] is the parked request of process p
+    // (at most one blocking request per process at a time)
+    BankerPolicy policy;
+    BankerWaiter **waiter_of;
+    pthread_t detector;
+    pthread_cond_t detector_wakeup;
+    bool detector_running;
+    bool detector_stop;
+    bool recover_deadlocks;
+    int detect_interval_ms;
+    DeadlockCallback on_deadlock;
+    void *callback_context;
+    long detector_runs;
+    long deadlocks_found;
+    long requests_aborted;
+
+    // Combiner scratch, grown on demand
+    BankerOp **ops;
+    BankerRequest *batch;
+    BankerVerdict *verdicts;
+    int capacity;
+} BankerManager;
+
+// Function to create a manager that owns the given state
+BankerManager *create_banker_manager(BankerState *bs)
+{
+    BankerManager *mgr = calloc(1, sizeof(BankerManager));
+    if (mgr == NULL)
+    {
+        return NULL;
+    }
+
+    mgr->waiting = calloc(bs->num_resources + 1, sizeof(WaitList));
+    mgr->released = calloc(bs->num_resources, sizeof(bool));
+    mgr->waiter_of = calloc(bs->num_processes, sizeof(BankerWaiter *));
+    if (mgr->waiting == NULL || mgr->released == NULL || mgr->waiter_of == NULL)
+    {
+        free(mgr->waiting);
+        free(mgr->released);
+        free(mgr->waiter_of);
+        free(mgr);
+        return NULL;
+    }
+
+    mgr->state = bs;
+    mgr->policy = BANKER_AVOIDANCE;
+    pthread_mutex_init(&mgr->combine_lock, NULL);
+    pthread_cond_init(&mgr->detector_wakeup, NULL);
+    atomic_init(&mgr->pending, NULL);
+
+    if (!bs->known_safe)
+    {
+        initialize_safety_engine(bs);
+    }
+
+    return mgr;
+}
+
+// Function to free a manager and its state; no thread may still be waiting
+void destroy_banker_manager(BankerManager *mgr)
+{
+    if (mgr == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_destroy(&mgr->combine_lock);
+    pthread_cond_destroy(&mgr->detector_wakeup);
+    destroy_banker_state(mgr->state);
+    free(mgr->ops);
+    free(mgr->batch);
+    free(mgr->verdicts);
+    free(mgr->waiting);
+    free(mgr->released);
+    free(mgr->waiter_of);
+    free(mgr);
+}
+
+// First resource the request asks more of than is available, or -1
+static int find_short_resource(const BankerState *bs, const int units[])
+{
+    for (int j = 0; j < bs->num_resources; j++)
+    {
+        if (units[j] > bs->available[j])
+        {
+            return j;
+        }
+    }
+    return -1;
+}
+
+static void append_waiter(BankerManager *mgr, int index, BankerWaiter *w)
+{
+    WaitList *list = &mgr->waiting[index];
+    w->list = index;
+    w->next = NULL;
+    if (list->tail != NULL)
+    {
+        list->tail->next = w;
+    }
+    else
+    {
+        list->head = w;
+    }
+    list->tail = w;
+}
+
+// Unlink a waiter from its wait list
+static void remove_waiter(BankerManager *mgr, BankerWaiter *w)
+{
+    WaitList *list = &mgr->waiting[w->list];
+    BankerWaiter *prev = NULL;
+
+    for (BankerWaiter *cur = list->head; cur != NULL; prev = cur, cur = cur->next)
+    {
+        if (cur == w)
+        {
+            if (prev != NULL)
+            {
+                prev->next = w->next;
+            }
+            else
+            {
+                list->head = w->next;
+            }
+            if (list->tail == w)
+            {
+                list->tail = prev;
+            }
+            return;
+        }
+    }
+}
+
+// Park a new waiter and record its request for deadlock detection
+static void park_waiter(BankerManager *mgr, int index, BankerWaiter *w)
+{
+    BankerState *bs = mgr->state;
+
+    memcpy(bs->request, w->units, sizeof(int) * bs->num_resources);
+    row_add(BANKER_ROW(bs, requested, w->process), bs->request, bs->stride);
+    mgr->waiter_of[w->process] = w;
+    append_waiter(mgr, index, w);
+}
+
+// Hand a parked request its final verdict and wake its thread
+static void finish_waiter(BankerManager *mgr, BankerWaiter *w, BankerVerdict verdict)
+{
+    BankerState *bs = mgr->state;
+
+    memcpy(bs->request, w->units, sizeof(int) * bs->num_resources);
+    row_sub(BANKER_ROW(bs, requested, w->process), bs->request, bs->stride);
+    mgr->waiter_of[w->process] = NULL;
+
+    w->verdict = verdict;
+    w->woken = true;
+    pthread_cond_signal(&w->wakeup);
+}
+
+// Grant a padded request row under the manager's policy
+static BankerVerdict grant_by_policy(BankerManager *mgr, int p, const int *padded)
+{
+    BankerState *bs = mgr->state;
+
+    if (mgr->policy == BANKER_AVOIDANCE)
+    {
+        return try_grant(bs, p, padded);
+    }
+
+    // Detection: grant whatever fits; the state may no longer be safe
+    BankerVerdict verdict = check_request_bounds(bs, p, padded);
+    if (verdict == BANKER_GRANTED)
+    {
+        apply_grant(bs, p, padded);
+        bs->known_safe = false;
+        bs->sequence_valid = false;
+    }
+    return verdict;
+}
+
+// Grant a parked request if it now fits and is safe, otherwise file it
+// under whatever still blocks it
+static void retry_waiter(BankerManager *mgr, BankerWaiter *w)
+{
+    BankerState *bs = mgr->state;
+    int short_resource = find_short_resource(bs, w->units);
+
+    if (short_resource >= 0)
+    {
+        append_waiter(mgr, short_resource, w);
+        return;
+    }
+
+    memcpy(bs->request, w->units, sizeof(int) * bs->num_resources);
+    BankerVerdict verdict = grant_by_policy(mgr, w->process, bs->request);
+    if (verdict == BANKER_UNSAFE)
+    {
+        append_waiter(mgr, bs->num_resources, w);
+        return;
+    }
+
+    finish_waiter(mgr, w, verdict);
+}
+
+// Re-evaluate only the waiters a release could have unblocked: any release
+// may make an unsafe request safe, but a request short on resource j only
+// needs another look once j was returned. Caller holds the combine lock.
+static void wake_waiters(BankerManager *mgr)
+{
+    int m = mgr->state->num_resources;
+    bool any_released = false;
+
+    for (int j = 0; j < m; j++)
+    {
+        any_released |= mgr->released[j];
+    }
+    if (!any_released)
+    {
+        return;
+    }
+
+    // Waiters blocked by safety first, so requests moved there below are not
+    // checked twice in one pass
+    for (int j = m; j >= 0; j--)
+    {
+        if (j < m && !mgr->released[j])
+        {
+            continue;
+        }
+
+        BankerWaiter *w = mgr->waiting[j].head;
+        mgr->waiting[j].head = mgr->waiting[j].tail = NULL;
+        while (w != NULL)
+        {
+            BankerWaiter *next = w->next;
+            retry_waiter(mgr, w);
+            w = next;
+        }
+    }
+
+    memset(mgr->released, 0, sizeof(bool) * m);
+}
+
+// Note which resources a release returned
+static void mark_released(BankerManager *mgr, const int units[])
+{
+    for (int j = 0; j < mgr->state->num_resources; j++)
+    {
+        if (units[j] > 0)
+        {
+            mgr->released[j] = true;
+        }
+    }
+}
+
+// Make room for `count` operations in the combiner scratch
+static bool reserve_combiner_scratch(BankerManager *mgr, int count)
+{
+    if (count <= mgr->capacity)
+    {
+        return true;
+    }
+
+    int capacity = mgr->capacity > 0 ? mgr->capacity : 64;
+    while (capacity < count)
+    {
+        capacity *= 2;
+    }
+
+    BankerOp **ops = realloc(mgr->ops, sizeof(BankerOp *) * capacity);
+    if (ops != NULL)
+    {
+        mgr->ops = ops;
+    }
+    BankerRequest *batch = realloc(mgr->batch, sizeof(BankerRequest) * capacity);
+    if (batch != NULL)
+    {
+        mgr->batch = batch;
+    }
+    BankerVerdict *verdicts = realloc(mgr->verdicts, sizeof(BankerVerdict) * capacity);
+    if (verdicts != NULL)
+    {
+        mgr->verdicts = verdicts;
+    }
+    if (ops == NULL || batch == NULL || verdicts == NULL)
+    {
+        return false;
+    }
+
+    mgr->capacity = capacity;
+    return true;
+}
+
+// Apply every published operation; caller holds the combine lock
+static void combine_pending_ops(BankerManager *mgr)
+{
+    BankerState *bs = mgr->state;
+    BankerOp *list;
+
+    while ((list = atomic_exchange_explicit(&mgr->pending, NULL, memory_order_acquire)) != NULL)
+    {
+        // Collect the operations in submission order
+        int count = 0;
+        for (BankerOp *op = list; op != NULL; op = op->next)
+        {
+            count++;
+        }
+        if (!reserve_combiner_scratch(mgr, count))
+        {
+            // Fail the operations rather than leave their threads spinning
+            for (BankerOp *op = list; op != NULL;)
+            {
+                BankerOp *next = op->next;
+                op->verdict = BANKER_NO_MEMORY;
+                atomic_store_explicit(&op->done, 1, memory_order_release);
+                op = next;
+            }
+            continue;
+        }
+        int k = count;
+        for (BankerOp *op = list; op != NULL; op = op->next)
+        {
+            mgr->ops[--k] = op;
+        }
+
+        // Releases first: they only make room for the requests
+        int num_requests = 0;
+        for (k = 0; k < count; k++)
+        {
+            BankerOp *op = mgr->ops[k];
+            if (op->type == BANKER_OP_RELEASE)
+            {
+                memcpy(bs->request, op->units, sizeof(int) * bs->num_resources);
+                op->verdict = try_release(bs, op->process, bs->request);
+                if (op->verdict == BANKER_GRANTED)
+                {
+                    mark_released(mgr, op->units);
+                }
+            }
+            else
+            {
+                mgr->batch[num_requests].process = op->process;
+                mgr->batch[num_requests].request = op->units;
+                mgr->ops[num_requests++] = op;
+            }
+        }
+
+        // Parked requests get the returned resources before new requests
+        wake_waiters(mgr);
+
+        // All requests are admitted with a single batched safety evaluation,
+        // or granted as they fit when detection replaces avoidance
+        if (mgr->policy == BANKER_AVOIDANCE)
+        {
+            request_resources_batch(bs, mgr->batch, num_requests, mgr->verdicts);
+        }
+        else
+        {
+            for (k = 0; k < num_requests; k++)
+            {
+                memcpy(bs->request, mgr->batch[k].request, sizeof(int) * bs->num_resources);
+                mgr->verdicts[k] = grant_by_policy(mgr, mgr->batch[k].process, bs->request);
+            }
+        }
+
+        for (k = 0; k < num_requests; k++)
+        {
+            mgr->ops[k]->verdict = mgr->verdicts[k];
+        }
+
+        // Publish completion; releases were already answered above
+        for (BankerOp *op = list; op != NULL;)
+        {
+            BankerOp *next = op->next;
+            atomic_store_explicit(&op->done, 1, memory_order_release);
+            op = next;
+        }
+    }
+}
+
+// Publish an operation and wait for a combiner (possibly this thread) to run it;
+// the verdict is BANKER_NO_MEMORY if the combiner could not allocate scratch
+static BankerVerdict submit_banker_op(BankerManager *mgr, BankerOp *op)
+{
+    atomic_init(&op->done, 0);
+    op->next = atomic_load_explicit(&mgr->pending, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&mgr->pending, &op->next, op,
+                                                  memory_order_release, memory_order_relaxed))
+    {
+    }
+
+    while (!atomic_load_explicit(&op->done, memory_order_acquire))
+    {
+        if (pthread_mutex_trylock(&mgr->combine_lock) == 0)
+        {
+            combine_pending_ops(mgr);
+            pthread_mutex_unlock(&mgr->combine_lock);
+        }
+        else
+        {
+            sched_yield();
+        }
+    }
+
+    return op->verdict;
+}
+
+// Thread-safe resource request
+BankerVerdict manager_request_resources(BankerManager *mgr, int process_num, const int request[])
+{
+    BankerOp op = {.type = BANKER_OP_REQUEST, .process = process_num, .units = request};
+    return submit_banker_op(mgr, &op);
+}
+
+// Thread-safe resource release
+BankerVerdict manager_release_resources(BankerManager *mgr, int process_num, const int release[])
+{
+    BankerOp op = {.type = BANKER_OP_RELEASE, .process = process_num, .units = release};
+    return submit_banker_op(mgr, &op);
+}
+
+// Thread-safe resource request that blocks instead of failing
+// A request that is short on resources or would be unsafe is parked until a
+// release lets it through; only invalid requests return an error. Under
+// detection a parked request may come back BANKER_ABORTED to break a
+// deadlock, and the caller must then release what the process holds.
+BankerVerdict manager_request_resources_wait(BankerManager *mgr, int process_num, const int request[])
+{
+    BankerState *bs = mgr->state;
+    BankerWaiter w = {.process = process_num, .units = request};
+
+    pthread_mutex_lock(&mgr->combine_lock);
+
+    // Serve everything published before this request
+    combine_pending_ops(mgr);
+
+    memcpy(bs->request, request, sizeof(int) * bs->num_resources);
+    w.verdict = grant_by_policy(mgr, process_num, bs->request);
+
+    if (w.verdict == BANKER_INSUFFICIENT || w.verdict == BANKER_UNSAFE)
+    {
+        // Park under the resource that is short, or with the unsafe requests
+        int short_resource = find_short_resource(bs, request);
+        pthread_cond_init(&w.wakeup, NULL);
+        park_waiter(mgr, short_resource >= 0 ? short_resource : bs->num_resources, &w);
+        while (!w.woken)
+        {
+            pthread_cond_wait(&w.wakeup, &mgr->combine_lock);
+        }
+        pthread_cond_destroy(&w.wakeup);
+    }
+
+    pthread_mutex_unlock(&mgr->combine_lock);
+    return w.verdict;
+}
+
+// Switch between avoidance and detection; switching back to avoidance
+// fails while the current state is unsafe
+bool set_manager_policy(BankerManager *mgr, BankerPolicy policy)
+{
+    bool ok = true;
+
+    pthread_mutex_lock(&mgr->combine_lock);
+    combine_pending_ops(mgr);
+    if (policy == BANKER_AVOIDANCE && mgr->policy != BANKER_AVOIDANCE)
+    {
+        initialize_safety_engine(mgr->state);
+        ok = mgr->state->known_safe;
+    }
+    if (ok)
+    {
+        mgr->policy = policy;
+    }
+    pthread_mutex_unlock(&mgr->combine_lock);
+
+    return ok;
+}
+
+// Abort the parked request of the deadlocked process holding the fewest
+// units, so its caller releases them; caller holds the combine lock
+static void abort_deadlock_victim(BankerManager *mgr, const int deadlocked[], int count)
+{
+    BankerState *bs = mgr->state;
+    BankerWaiter *victim = NULL;
+    long victim_units = 0;
+
+    for (int k = 0; k < count; k++)
+    {
+        BankerWaiter *w = mgr->waiter_of[deadlocked[k]];
+        if (w == NULL)
+        {
+            continue;
+        }
+
+        const int *allocation_p = BANKER_ROW(bs, allocation, deadlocked[k]);
+        long units = 0;
+        for (int j = 0; j < bs->num_resources; j++)
+        {
+            units += allocation_p[j];
+        }
+        if (victim == NULL || units < victim_units)
+        {
+            victim = w;
+            victim_units = units;
+        }
+    }
+
+    if (victim != NULL)
+    {
+        remove_waiter(mgr, victim);
+        finish_waiter(mgr, victim, BANKER_ABORTED);
+        mgr->requests_aborted++;
+    }
+}
+
+// Background detector: runs detection every interval, optionally aborts a
+// victim and reports the deadlocked set to the callback
+static void *deadlock_detector(void *arg)
+{
+    BankerManager *mgr = arg;
+    int *deadlocked = malloc(sizeof(int) * mgr->state->num_processes);
+
+    pthread_mutex_lock(&mgr->combine_lock);
+    while (!mgr->detector_stop)
+    {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += (long)mgr->detect_interval_ms * 1000000;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000;
+        deadline.tv_nsec %= 1000000000;
+
+        pthread_cond_timedwait(&mgr->detector_wakeup, &mgr->combine_lock, &deadline);
+        if (mgr->detector_stop)
+        {
+            break;
+        }
+
+        int count = detect_deadlock(mgr->state, deadlocked);
+        mgr->detector_runs++;
+        if (count == 0)
+        {
+            continue;
+        }
+
+        mgr->deadlocks_found++;
+        if (mgr->recover_deadlocks)
+        {
+            abort_deadlock_victim(mgr, deadlocked, count);
+        }
+
+        // Report without holding the lock
+        if (mgr->on_deadlock != NULL)
+        {
+            pthread_mutex_unlock(&mgr->combine_lock);
+            mgr->on_deadlock(deadlocked, count, mgr->callback_context);
+            pthread_mutex_lock(&mgr->combine_lock);
+        }
+    }
+    pthread_mutex_unlock(&mgr->combine_lock);
+
+    free(deadlocked);
+    return NULL;
+}
+
+// Start periodic detection; with `recover` set each detected deadlock
+// aborts one parked request. The callback may be NULL.
+bool start_deadlock_detector(BankerManager *mgr, int interval_ms, bool recover,
+                             DeadlockCallback callback, void *context)
+{
+    if (mgr->detector_running || interval_ms <= 0)
+    {
+        return false;
+    }
+
+    mgr->detect_interval_ms = interval_ms;
+    mgr->recover_deadlocks = recover;
+    mgr->on_deadlock = callback;
+    mgr->callback_context = context;
+    mgr->detector_stop = false;
+
+    if (pthread_create(&mgr->detector, NULL, deadlock_detector, mgr) != 0)
+    {
+        return false;
+    }
+    mgr->detector_running = true;
+    return true;
+}
+
+// Stop the detector thread and wait for it to exit
+void stop_deadlock_detector(BankerManager *mgr)
+{
+    if (!mgr->detector_running)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&mgr->combine_lock);
+    mgr->detector_stop = true;
+    pthread_cond_signal(&mgr->detector_wakeup);
+    pthread_mutex_unlock(&mgr->combine_lock);
+
+    pthread_join(mgr->detector, NULL);
+    mgr->detector_running = false;
+}
+
+// Consistent snapshot of the available vector, taken under the combine
+// lock since the combiner updates it with plain vector stores
+void manager_read_available(BankerManager *mgr, int out[])
+{
+    pthread_mutex_lock(&mgr->combine_lock);
+    memcpy(out, mgr->state->available, sizeof(int) * mgr->state->num_resources);
+    pthread_mutex_unlock(&mgr->combine_lock);
+}
+
+// Small per-thread random number generator (xorshift32)
+static unsigned int next_random(unsigned int *seed)
+{
+    unsigned int x = *seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *seed = x;
+    return x;
+}
+
+// Function to generate a random safe state
+// Every process claims up to 10 units of each resource. Tightness in [0, 1]
+// sets how scarce resources are: at 0 the system owns enough to satisfy all
+// claims at once, at 1 only enough for the largest single claim. Each
+// process is then granted a random part of its claim through the normal
+// admission path, so the generated state is always safe.
+BankerState *generate_banker_state(int n, int m, double tightness, unsigned int seed)
+{
+    BankerState *bs = create_banker_state(n, m);
+    if (bs == NULL)
+    {
+        return NULL;
+    }
+
+    if (seed == 0)
+    {
+        seed = 1;
+    }
+    if (tightness < 0.0)
+    {
+        tightness = 0.0;
+    }
+    if (tightness > 1.0)
+    {
+        tightness = 1.0;
+    }
+
+    // Draw the claims, tracking total and largest claim per resource
+    int *largest = calloc(m, sizeof(int));
+    long *total = calloc(m, sizeof(long));
+    if (largest == NULL || total == NULL)
+    {
+        free(largest);
+        free(total);
+        destroy_banker_state(bs);
+        return NULL;
+    }
+    for (int i = 0; i < n; i++)
+    {
+        int *max_i = BANKER_ROW(bs, max, i);
+        int *need_i = BANKER_ROW(bs, need, i);
+        for (int j = 0; j < m; j++)
+        {
+            max_i[j] = need_i[j] = next_random(&seed) % 11;
+            total[j] += max_i[j];
+            if (max_i[j] > largest[j])
+            {
+                largest[j] = max_i[j];
+            }
+        }
+    }
+    for (int j = 0; j < m; j++)
+    {
+        bs->available[j] = largest[j] + (int)((1.0 - tightness) * (total[j] - largest[j]));
+    }
+    free(largest);
+    free(total);
+
+    // Nothing is allocated yet and every claim fits, so this is safe
+    initialize_safety_engine(bs);
+
+    // Hand out part of each claim as one batch
+    int *units = malloc(sizeof(int) * (size_t)n * m);
+    BankerRequest *requests = malloc(sizeof(BankerRequest) * n);
+    BankerVerdict *verdicts = malloc(sizeof(BankerVerdict) * n);
+    if (units == NULL || requests == NULL || verdicts == NULL)
+    {
+        free(units);
+        free(requests);
+        free(verdicts);
+        destroy_banker_state(bs);
+        return NULL;
+    }
+    for (int i = 0; i < n; i++)
+    {
+        const int *max_i = BANKER_ROW(bs, max, i);
+        int *units_i = units + (size_t)i * m;
+        for (int j = 0; j < m; j++)
+        {
+            units_i[j] = next_random(&seed) % (max_i[j] + 1) / 2;
+        }
+        requests[i].process = i;
+        requests[i].request = units_i;
+    }
+    request_resources_batch(bs, requests, n, verdicts);
+
+    free(units);
+    free(requests);
+    free(verdicts);
+    return bs;
+}
+
+// Monotonic clock in nanoseconds
+static double now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Time one set of row kernels on rows of `length` ints
+static void benchmark_row_kernels(const char *name, RowLessEqualFn less_equal,
+                                  RowUpdateFn add, RowUpdateFn sub,
+                                  int *a, int *b, int length, long iterations)
+{
+    volatile int sink = 0;
+
+    // Comparisons that pass scan the whole row, which is the worst case
+    double start = now_ns();
+    for (long it = 0; it < iterations; it++)
+    {
+        sink += less_equal(a, b, length);
+    }
+    double compare_ns = (now_ns() - start) / iterations;
+
+    // Add then subtract so the rows stay unchanged between iterations
+    start = now_ns();
+    for (long it = 0; it < iterations; it++)
+    {
+        add(b, a, length);
+        sub(b, a, length);
+    }
+    double update_ns = (now_ns() - start) / (2.0 * iterations);
+
+    printf("%-8s  compare %8.2f ns/row   add/sub %8.2f ns/row\n",
+           name, compare_ns, update_ns);
+    (void)sink;
+}
+
+// Micro-benchmark of the scalar and SIMD row kernels
+int run_row_kernel_benchmark(int argc, char *argv[])
+{
+    int m = argc > 0 ? atoi(argv[0]) : 256;
+    long iterations = argc > 1 ? atol(argv[1]) : 1000000;
+
+    if (m <= 0 || iterations <= 0)
+    {
+        printf("Usage: banker --bench-simd [resources] [iterations]\n");
+        return 1;
+    }
+
+    int length = (m + BANKER_LANE_WIDTH - 1) / BANKER_LANE_WIDTH * BANKER_LANE_WIDTH;
+    int *a = aligned_alloc(BANKER_ALIGNMENT, banker_align(sizeof(int) * length));
+    int *b = aligned_alloc(BANKER_ALIGNMENT, banker_align(sizeof(int) * length));
+    for (int k = 0; k < length; k++)
+    {
+        a[k] = k < m ? rand() % 100 : 0;
+        b[k] = k < m ? a[k] + rand() % 100 : 0;
+    }
+
+    select_row_kernels();
+    printf("Row kernels over %d resources (%ld iterations), dispatch = %s\n",
+           m, iterations, row_kernel_name);
+
+    benchmark_row_kernels("scalar", row_less_equal_scalar, row_add_scalar,
+                          row_sub_scalar, a, b, length, iterations);
+#ifdef BANKER_HAVE_X86_KERNELS
+    if (__builtin_cpu_supports("sse4.1"))
+    {
+        benchmark_row_kernels("sse4.1", row_less_equal_sse41, row_add_sse41,
+                              row_sub_sse41, a, b, length, iterations);
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        benchmark_row_kernels("avx2", row_less_equal_avx2, row_add_avx2,
+                              row_sub_avx2, a, b, length, iterations);
+    }
+#endif
+
+    free(a);
+    free(b);
+    return 0;
+}
+
+// Worker for the manager throughput benchmark
+typedef struct ManagerWorker
+{
+    BankerManager *manager;
+    int first_process; // Processes first_process, +stride, ... belong to this worker
+    int process_stride;
+    long operations;
+    unsigned int seed;
+    long granted;
+} ManagerWorker;
+
+static void *manager_worker(void *arg)
+{
+    ManagerWorker *w = arg;
+    BankerState *bs = w->manager->state;
+    int n = bs->num_processes;
+    int m = bs->num_resources;
+    int owned = (n - w->first_process + w->process_stride - 1) / w->process_stride;
+    int *held = calloc((size_t)owned * m, sizeof(int));
+    int *units = malloc(sizeof(int) * m);
+
+    for (long op = 0; op < w->operations; op++)
+    {
+        int slot = next_random(&w->seed) % owned;
+        int p = w->first_process + slot * w->process_stride;
+        const int *max_p = BANKER_ROW(bs, max, p); // max never changes
+        int *held_p = held + (size_t)slot * m;
+
+        if (next_random(&w->seed) % 4 == 0)
+        {
+            // Return everything this process holds
+            manager_release_resources(w->manager, p, held_p);
+            memset(held_p, 0, sizeof(int) * m);
+            continue;
+        }
+
+        for (int j = 0; j < m; j++)
+        {
+            int remaining = max_p[j] - held_p[j];
+            units[j] = remaining > 0 ? next_random(&w->seed) % (remaining + 1) / 2 : 0;
+        }
+        if (manager_request_resources(w->manager, p, units) == BANKER_GRANTED)
+        {
+            w->granted++;
+            for (int j = 0; j < m; j++)
+            {
+                held_p[j] += units[j];
+            }
+        }
+    }
+
+    free(held);
+    free(units);
+    return NULL;
+}
+
+// Throughput of the concurrent manager at 1/4/16/64 threads
+int run_manager_benchmark(int argc, char *argv[])
+{
+    int n = argc > 0 ? atoi(argv[0]) : 256;
+    int m = argc > 1 ? atoi(argv[1]) : 16;
+    long total_ops = argc > 2 ? atol(argv[2]) : 200000;
+    const int thread_counts[] = {1, 4, 16, 64};
+
+    if (n < 64 || m <= 0 || total_ops <= 0)
+    {
+        printf("Usage: banker --bench-threads [processes >= 64] [resources] [operations]\n");
+        return 1;
+    }
+
+    printf("Concurrent manager: %d processes x %d resources, %ld operations per run\n",
+           n, m, total_ops);
+
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++)
+    {
+        int threads = thread_counts[t];
+        BankerState *bs = generate_banker_state(n, m, 0.5, 42);
+        BankerManager *mgr = bs != NULL ? create_banker_manager(bs) : NULL;
+        if (mgr == NULL)
+        {
+            printf("Error: Cannot create a %d x %d state!\n", n, m);
+            destroy_banker_state(bs);
+            return 1;
+        }
+        pthread_t *ids = malloc(sizeof(pthread_t) * threads);
+        ManagerWorker *workers = calloc(threads, sizeof(ManagerWorker));
+
+        double start = now_ns();
+        for (int i = 0; i < threads; i++)
+        {
+            workers[i].manager = mgr;
+            workers[i].first_process = i;
+            workers[i].process_stride = threads;
+            workers[i].operations = total_ops / threads;
+            workers[i].seed = 0x9e3779b9u * (i + 1);
+            pthread_create(&ids[i], NULL, manager_worker, &workers[i]);
+        }
+
+        long granted = 0;
+        for (int i = 0; i < threads; i++)
+        {
+            pthread_join(ids[i], NULL);
+            granted += workers[i].granted;
+        }
+        double seconds = (now_ns() - start) / 1e9;
+
+        printf("%3d threads: %12.0f ops/sec, %ld requests granted\n",
+               threads, (total_ops / threads) * threads / seconds, granted);
+
+        free(ids);
+        free(workers);
+        destroy_banker_manager(mgr);
+    }
+
+    return 0;
+}
+
+// Worker for the avoidance vs detection benchmark; owns one process and
+// uses blocking requests
+typedef struct BlockingWorker
+{
+    BankerManager *manager;
+    int process;
+    long operations;
+    unsigned int seed;
+    int *held;
+    long granted;
+    long aborted;
+} BlockingWorker;
+
+static void *blocking_worker(void *arg)
+{
+    BlockingWorker *w = arg;
+    BankerState *bs = w->manager->state;
+    int m = bs->num_resources;
+    const int *max_p = BANKER_ROW(bs, max, w->process); // max never changes
+    int *units = malloc(sizeof(int) * m);
+
+    for (long op = 0; op < w->operations; op++)
+    {
+        bool complete = true;
+        for (int j = 0; j < m; j++)
+        {
+            int remaining = max_p[j] - w->held[j];
+            units[j] = remaining > 0 ? next_random(&w->seed) % (remaining + 1) : 0;
+            complete &= units[j] == remaining;
+        }
+
+        BankerVerdict verdict = manager_request_resources_wait(w->manager, w->process, units);
+        if (verdict == BANKER_GRANTED)
+        {
+            w->granted++;
+            for (int j = 0; j < m; j++)
+            {
+                w->held[j] += units[j];
+            }
+        }
+        else if (verdict == BANKER_ABORTED)
+        {
+            w->aborted++;
+            complete = true;
+        }
+
+        // Finish the job once the full claim is held, sometimes earlier
+        if (complete || next_random(&w->seed) % 3 == 0)
+        {
+            manager_release_resources(w->manager, w->process, w->held);
+            memset(w->held, 0, sizeof(int) * m);
+        }
+    }
+
+    // Hand back whatever is still held so the remaining workers can finish
+    manager_release_resources(w->manager, w->process, w->held);
+    free(units);
+    return NULL;
+}
+
+// Throughput of avoidance against detect-and-recover on the same workload
+int run_detection_benchmark(int argc, char *argv[])
+{
+    int threads = argc > 0 ? atoi(argv[0]) : 16;
+    int m = argc > 1 ? atoi(argv[1]) : 8;
+    long operations = argc > 2 ? atol(argv[2]) : 20000;
+    int interval_ms = argc > 3 ? atoi(argv[3]) : 1;
+
+    if (threads <= 0 || m <= 0 || operations <= 0 || interval_ms <= 0)
+    {
+        printf("Usage: banker --bench-detect [threads] [resources] [operations] [interval ms]\n");
+        return 1;
+    }
+
+    printf("Avoidance vs detection: %d threads x %d resources, %ld operations per thread\n",
+           threads, m, operations);
+
+    for (int run = 0; run < 2; run++)
+    {
+        BankerPolicy policy = run == 0 ? BANKER_AVOIDANCE : BANKER_DETECTION;
+        BankerState *bs = generate_banker_state(threads, m, 0.7, 42);
+        BankerManager *mgr = bs != NULL ? create_banker_manager(bs) : NULL;
+        if (mgr == NULL)
+        {
+            printf("Error: Cannot create a %d x %d state!\n", threads, m);
+            destroy_banker_state(bs);
+            return 1;
+        }
+        pthread_t *ids = malloc(sizeof(pthread_t) * threads);
+        BlockingWorker *workers = calloc(threads, sizeof(BlockingWorker));
+
+        set_manager_policy(mgr, policy);
+        if (policy == BANKER_DETECTION)
+        {
+            start_deadlock_detector(mgr, interval_ms, true, NULL, NULL);
+        }
+
+        // Workers start out holding what the generator granted
+        for (int i = 0; i < threads; i++)
+        {
+            workers[i].manager = mgr;
+            workers[i].process = i;
+            workers[i].operations = operations;
+            workers[i].seed = 0x9e3779b9u * (i + 1);
+            workers[i].held = malloc(sizeof(int) * m);
+            memcpy(workers[i].held, BANKER_ROW(mgr->state, allocation, i), sizeof(int) * m);
+        }
+
+        double start = now_ns();
+        for (int i = 0; i < threads; i++)
+        {
+            pthread_create(&ids[i], NULL, blocking_worker, &workers[i]);
+        }
+
+        long granted = 0, aborted = 0;
+        for (int i = 0; i < threads; i++)
+        {
+            pthread_join(ids[i], NULL);
+            granted += workers[i].granted;
+            aborted += workers[i].aborted;
+            free(workers[i].held);
+        }
+        double seconds = (now_ns() - start) / 1e9;
+        stop_deadlock_detector(mgr);
+
+        printf("%-9s: %10.0f requests/sec, %ld granted, %ld aborted",
+               policy == BANKER_AVOIDANCE ? "avoidance" : "detection",
+               operations * threads / seconds, granted, aborted);
+        if (policy == BANKER_DETECTION)
+        {
+            printf(", %ld deadlocks in %ld detector runs",
+                   mgr->deadlocks_found, mgr->detector_runs);
+        }
+        printf("\n");
+
+        free(ids);
+        free(workers);
+        destroy_banker_manager(mgr);
+    }
+
+    return 0;
+}
+
+// Load a snapshot and report whether it is safe
+int run_snapshot_check(int argc, char *argv[])
+{
+    if (argc < 1)
+    {
+        printf("Usage: banker --load <snapshot>\n");
+        return 1;
+    }
+
+    double start = now_ns();
+    BankerState *bs = load_banker_snapshot(argv[0]);
+    double loaded = now_ns();
+    if (bs == NULL)
+    {
+        printf("Error: Cannot load snapshot %s!\n", argv[0]);
+        return 1;
+    }
+
+    initialize_safety_engine(bs);
+    double checked = now_ns();
+
+    printf("Loaded %d processes x %d resources in %.3f ms\n",
+           bs->num_processes, bs->num_resources, (loaded - start) / 1e6);
+    printf("System state is %s (check took %.3f ms)\n",
+           bs->known_safe ? "SAFE" : "UNSAFE", (checked - loaded) / 1e6);
+
+    destroy_banker_state(bs);
+    return 0;
+}
+
+// Convert a snapshot between formats; a .csv output path writes CSV
+int run_snapshot_convert(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printf("Usage: banker --convert <input> <output[.csv]>\n");
+        return 1;
+    }
+
+    BankerState *bs = load_banker_snapshot(argv[0]);
+    if (bs == NULL)
+    {
+        printf("Error: Cannot load snapshot %s!\n", argv[0]);
+        return 1;
+    }
+
+    size_t length = strlen(argv[1]);
+    bool csv = length >= 4 && strcmp(argv[1] + length - 4, ".csv") == 0;
+    bool ok = csv ? save_banker_csv(bs, argv[1]) : save_banker_snapshot(bs, argv[1]);
+    if (!ok)
+    {
+        printf("Error: Cannot write snapshot %s!\n", argv[1]);
+    }
+
+    destroy_banker_state(bs);
+    return ok ? 0 : 1;
+}
+
+// Sort helper for latency samples
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Replay a random request/release stream against a generated state
+int run_admission_benchmark(int argc, char *argv[])
+{
+    int n = argc > 0 ? atoi(argv[0]) : 1000;
+    int m = argc > 1 ? atoi(argv[1]) : 32;
+    double tightness = argc > 2 ? atof(argv[2]) : 0.5;
+    long operations = argc > 3 ? atol(argv[3]) : 100000;
+    unsigned int seed = argc > 4 ? (unsigned int)atol(argv[4]) : 42;
+
+    if (n <= 0 || m <= 0 || operations <= 0)
+    {
+        printf("Usage: banker --bench [processes] [resources] [tightness] [operations] [seed]\n");
+        return 1;
+    }
+
+    double start = now_ns();
+    BankerState *bs = generate_banker_state(n, m, tightness, seed);
+    if (bs == NULL)
+    {
+        printf("Error: Cannot create a %d x %d state!\n", n, m);
+        return 1;
+    }
+    printf("Generated %d processes x %d resources (tightness %.2f) in %.1f ms\n",
+           n, m, tightness, (now_ns() - start) / 1e6);
+
+    double *latency = malloc(sizeof(double) * operations);
+    long requests = 0, releases = 0;
+    long granted = 0, unsafe = 0, insufficient = 0;
+    double check_time = 0.0;
+
+    for (long op = 0; op < operations; op++)
+    {
+        int p = next_random(&seed) % n;
+        const int *allocation_p = BANKER_ROW(bs, allocation, p);
+        const int *need_p = BANKER_ROW(bs, need, p);
+
+        // One operation in four returns part of what the process holds
+        if (next_random(&seed) % 4 == 0)
+        {
+            for (int j = 0; j < m; j++)
+            {
+                bs->request[j] = next_random(&seed) % (allocation_p[j] + 1);
+            }
+            try_release(bs, p, bs->request);
+            releases++;
+            continue;
+        }
+
+        for (int j = 0; j < m; j++)
+        {
+            bs->request[j] = next_random(&seed) % (need_p[j] + 1);
+        }
+
+        double t0 = now_ns();
+        BankerVerdict verdict = try_grant(bs, p, bs->request);
+        double elapsed = now_ns() - t0;
+
+        latency[requests++] = elapsed;
+        if (verdict == BANKER_GRANTED)
+        {
+            granted++;
+            check_time += elapsed;
+        }
+        else if (verdict == BANKER_UNSAFE)
+        {
+            unsafe++;
+            check_time += elapsed;
+        }
+        else
+        {
+            insufficient++;
+        }
+    }
+
+    long checks = granted + unsafe;
+    qsort(latency, requests, sizeof(double), compare_doubles);
+
+    printf("Operations: %ld requests, %ld releases\n", requests, releases);
+    printf("Verdicts: %ld granted, %ld unsafe, %ld insufficient\n",
+           granted, unsafe, insufficient);
+    if (checks > 0)
+    {
+        printf("Safe vs unsafe: %.1f%% / %.1f%% of %ld safety checks\n",
+               100.0 * granted / checks, 100.0 * unsafe / checks, checks);
+        printf("Checks/sec: %.0f\n", checks / (check_time / 1e9));
+    }
+    if (requests > 0)
+    {
+        printf("Request latency: p50 %.0f ns, p99 %.0f ns, max %.0f ns\n",
+               latency[requests / 2], latency[(long)(requests * 0.99)],
+               latency[requests - 1]);
+    }
+
+    free(latency);
+    destroy_banker_state(bs);
+    return 0;
+}
+
+// Cross-check the incremental safety engine against the reference
+// algorithm over a random request/release stream. Every request that fits
+// is applied and judged by both; the reference verdict decides whether it
+// stays. Releases and small batches are followed by a full check from
+// scratch. Returns nonzero if the two ever disagree.
+int run_safety_verification(int argc, char *argv[])
+{
+    int n = argc > 0 ? atoi(argv[0]) : 64;
+    int m = argc > 1 ? atoi(argv[1]) : 8;
+    long operations = argc > 2 ? atol(argv[2]) : 20000;
+    unsigned int seed = argc > 3 ? (unsigned int)atol(argv[3]) : 42;
+
+    if (n <= 0 || m <= 0 || operations <= 0)
+    {
+        printf("Usage: banker --verify [processes] [resources] [operations] [seed]\n");
+        return 1;
+    }
+
+    // Scarce resources, so that many requests are unsafe
+    BankerState *bs = generate_banker_state(n, m, 0.9, seed);
+    int *units = malloc(sizeof(int) * 4 * (size_t)m);
+    if (bs == NULL || units == NULL)
+    {
+        printf("Error: Cannot create a %d x %d state!\n", n, m);
+        destroy_banker_state(bs);
+        free(units);
+        return 1;
+    }
+
+    long checks = 0, unsafe = 0, mismatches = 0;
+    for (long op = 0; op < operations; op++)
+    {
+        int p = next_random(&seed) % n;
+        const int *allocation_p = BANKER_ROW(bs, allocation, p);
+        const int *need_p = BANKER_ROW(bs, need, p);
+        bool incremental, reference;
+        unsigned int kind = next_random(&seed) % 8;
+
+        if (kind < 2)
+        {
+            // Return part of what the process holds, then check from scratch
+            for (int j = 0; j < m; j++)
+            {
+                bs->request[j] = next_random(&seed) % (allocation_p[j] + 1);
+            }
+            try_release(bs, p, bs->request);
+            incremental = incremental_safe_check(bs, -1);
+            reference = reference_safe_check(bs, NULL);
+        }
+        else if (kind == 2)
+        {
+            // A small batch must leave the state safe
+            BankerRequest requests[4];
+            BankerVerdict verdicts[4];
+            for (int k = 0; k < 4; k++)
+            {
+                requests[k].process = next_random(&seed) % n;
+                requests[k].request = units + (size_t)k * m;
+                const int *need_k = BANKER_ROW(bs, need, requests[k].process);
+                for (int j = 0; j < m; j++)
+                {
+                    units[(size_t)k * m + j] = next_random(&seed) % (need_k[j] + 1) / 2;
+                }
+            }
+            request_resources_batch(bs, requests, 4, verdicts);
+            incremental = incremental_safe_check(bs, -1);
+            reference = reference_safe_check(bs, NULL);
+        }
+        else
+        {
+            for (int j = 0; j < m; j++)
+            {
+                bs->request[j] = next_random(&seed) % (need_p[j] + 1);
+            }
+            if (check_request_bounds(bs, p, bs->request) != BANKER_GRANTED)
+            {
+                continue;
+            }
+
+            // Judge the tentative grant both ways, as try_grant() would
+            apply_grant(bs, p, bs->request);
+            incremental = incremental_safe_check(bs, bs->known_safe ? p : -1);
+            reference = reference_safe_check(bs, NULL);
+            if (!reference)
+            {
+                revoke_grant(bs, p, bs->request);
+                unsafe++;
+            }
+            bs->known_safe = true;
+        }
+
+        checks++;
+        if (incremental != reference)
+        {
+            if (mismatches++ < 10)
+            {
+                printf("Mismatch at operation %ld (process P%d): incremental %s, reference %s\n",
+                       op, p, incremental ? "safe" : "unsafe", reference ? "safe" : "unsafe");
+            }
+        }
+    }
+
+    printf("Verified %ld safety checks on %d processes x %d resources (%ld unsafe): %ld mismatches\n",
+           checks, n, m, unsafe, mismatches);
+
+    free(units);
+    destroy_banker_state(bs);
+    return mismatches > 0 ? 1 : 0;
+}
+
+// Main function
+int main(int argc, char *argv[])
+{
+    // Benchmark modes
+    if (argc > 1 && strcmp(argv[1], "--bench-simd") == 0)
+    {
+        return run_row_kernel_benchmark(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        return run_admission_benchmark(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-threads") == 0)
+    {
+        return run_manager_benchmark(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-detect") == 0)
+    {
+        return run_detection_benchmark(argc - 2, argv + 2);
+    }
+
+    // Self-check of the incremental safety engine
+    if (argc > 1 && strcmp(argv[1], "--verify") == 0)
+    {
+        return run_safety_verification(argc - 2, argv + 2);
+    }
+
+    // Non-interactive snapshot modes
+    if (argc > 1 && strcmp(argv[1], "--load") == 0)
+    {
+        return run_snapshot_check(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "--convert") == 0)
+    {
+        return run_snapshot_convert(argc - 2, argv + 2);
+    }
+
+    // Input resource data
+    BankerState *bs = input_resource_data();
+    if (bs == NULL)
+    {
+        return 1;
+    }
+
+    // Display input matrices
+    display_matrices(bs);
+
+    // Prepare the incremental safety engine
+    initialize_safety_engine(bs);
+
+    // Check initial system state
+    printf("\nChecking Initial System State:\n");
+    if (is_safe_state(bs))
+    {
+        printf("Initial system state is SAFE.\n");
+    }
+    else
+    {
+        printf("Initial system state is UNSAFE.\n");
+    }
+
+    // Demonstration of resource request
+    int *example_request = calloc(bs->num_resources, sizeof(int));
+    printf("\nDemonstrating Resource Request:\n");
+    printf("Enter a process number (0 to %d): ", bs->num_processes - 1);
+    int process_num;
+    scanf("%d", &process_num);
+
+    if (process_num < 0 || process_num >= bs->num_processes)
+    {
+        printf("Error: Invalid process number!\n");
+    }
+    else
+    {
+        printf("Enter resource request for Process P%d:\n", process_num);
+        for (int i = 0; i < bs->num_resources; i++)
+        {
+            printf("  Resource %d request: ", i + 1);
+            scanf("%d", &example_request[i]);
+        }
+
+        // Request resources
+        request_resources(bs, process_num, example_request);
+    }
+
+    free(example_request);
+    destroy_banker_state(bs);
+
+    return 0;
+}
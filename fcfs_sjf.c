@@ -1,6 +1,13 @@
+#define _DEFAULT_SOURCE // For process_trace.h under -std=c11
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "process_sort.h"
+#include "process_trace.h"
 
 #define MAX_PROCESSES 100
 
@@ -10,6 +17,7 @@ typedef struct Process
     int process_id;      // Process ID
     int arrival_time;    // Arrival time
     int burst_time;      // Total CPU burst time
+    int remaining_time;  // Burst time still to run
     int waiting_time;    // Waiting time
     int turnaround_time; // Turnaround time
     int completion_time; // Completion time
@@ -18,9 +26,28 @@ typedef struct Process
 // Function prototypes
 void fcfs_scheduling(Process processes[], int n);
 void sjf_scheduling(Process processes[], int n);
+void srtf_scheduling(Process processes[], int n);
 void display_process_details(Process processes[], int n);
 void sort_by_arrival_time(Process processes[], int n);
 void sort_by_burst_time(Process processes[], int n);
+void ready_heap_push(int heap[], int *size, const Process processes[], int index);
+int ready_heap_pop(int heap[], int *size, const Process processes[]);
+int run_trace_simulation(int argc, char *argv[]);
+
+// Function to order two ready processes for SJF and SRTF: less remaining
+// time first, ties going to the earlier arrival and then the lower ID
+bool runs_before(const Process processes[], int a, int b)
+{
+    if (processes[a].remaining_time != processes[b].remaining_time)
+    {
+        return processes[a].remaining_time < processes[b].remaining_time;
+    }
+    if (processes[a].arrival_time != processes[b].arrival_time)
+    {
+        return processes[a].arrival_time < processes[b].arrival_time;
+    }
+    return processes[a].process_id < processes[b].process_id;
+}
 
 // First-Come, First-Served (FCFS) Scheduling
 void fcfs_scheduling(Process processes[], int n)
@@ -65,55 +92,62 @@ void fcfs_scheduling(Process processes[], int n)
 }
 
 // Shortest Job First (SJF) Scheduling
+// Event driven: processes are admitted in arrival order into a min-heap on
+// burst time, and the clock jumps straight to the next arrival when idle.
 void sjf_scheduling(Process processes[], int n)
 {
-    int total_waiting_time = 0, total_turnaround_time = 0;
-    Process temp_processes[MAX_PROCESSES];
+    long long total_waiting_time = 0, total_turnaround_time = 0;
+
+    if (n <= 0)
+    {
+        return;
+    }
+
+    Process *temp_processes = malloc(sizeof(Process) * n);
+    int *ready_heap = malloc(sizeof(int) * n);
+    if (temp_processes == NULL || ready_heap == NULL)
+    {
+        printf("Error: Memory allocation failed!\n");
+        free(temp_processes);
+        free(ready_heap);
+        return;
+    }
 
     // Create a copy of original processes
     for (int i = 0; i < n; i++)
     {
         temp_processes[i] = processes[i];
+        temp_processes[i].remaining_time = processes[i].burst_time;
     }
 
     // Sort processes by arrival time
     sort_by_arrival_time(temp_processes, n);
 
-    // Track completed processes
-    bool completed[MAX_PROCESSES] = {false};
     int current_time = 0;
-    int completed_count = 0;
+    int next_arrival = 0; // First process not yet admitted
+    int ready_count = 0;
 
     // SJF Scheduling
-    while (completed_count < n)
+    for (int completed_count = 0; completed_count < n; completed_count++)
     {
-        int shortest_job_index = -1;
-        int shortest_burst_time = INT_MAX;
-
-        // Find shortest job among arrived processes
-        for (int i = 0; i < n; i++)
+        // If no process is available, skip ahead to the next arrival
+        if (ready_count == 0 && current_time < temp_processes[next_arrival].arrival_time)
         {
-            if (!completed[i] &&
-                temp_processes[i].arrival_time <= current_time &&
-                temp_processes[i].burst_time < shortest_burst_time)
-            {
-                shortest_job_index = i;
-                shortest_burst_time = temp_processes[i].burst_time;
-            }
+            current_time = temp_processes[next_arrival].arrival_time;
         }
 
-        // If no process is available, increment time
-        if (shortest_job_index == -1)
+        // Admit every process that has arrived by now
+        while (next_arrival < n && temp_processes[next_arrival].arrival_time <= current_time)
         {
-            current_time++;
-            continue;
+            ready_heap_push(ready_heap, &ready_count, temp_processes, next_arrival++);
         }
 
         // Process the shortest job
-        int i = shortest_job_index;
+        int i = ready_heap_pop(ready_heap, &ready_count, temp_processes);
 
         // Calculate completion time
         current_time += temp_processes[i].burst_time;
+        temp_processes[i].remaining_time = 0;
         temp_processes[i].completion_time = current_time;
 
         // Calculate waiting time and turnaround time
@@ -129,10 +163,6 @@ void sjf_scheduling(Process processes[], int n)
         // Accumulate total times
         total_waiting_time += temp_processes[i].waiting_time;
         total_turnaround_time += temp_processes[i].turnaround_time;
-
-        // Mark process as completed
-        completed[i] = true;
-        completed_count++;
     }
 
     // Copy back to original processes
@@ -140,50 +170,236 @@ void sjf_scheduling(Process processes[], int n)
     {
         processes[i] = temp_processes[i];
     }
+    free(temp_processes);
+    free(ready_heap);
 
     // Print SJF results
     printf("\n--- Shortest Job First (SJF) Scheduling Results ---\n");
     display_process_details(processes, n);
 
     printf("\nSJF Scheduling Metrics:\n");
-    printf("Average Waiting Time: %.2f\n", (float)total_waiting_time / n);
-    printf("Average Turnaround Time: %.2f\n", (float)total_turnaround_time / n);
+    printf("Average Waiting Time: %.2f\n", (double)total_waiting_time / n);
+    printf("Average Turnaround Time: %.2f\n", (double)total_turnaround_time / n);
 }
 
-// Sort processes by arrival time
-void sort_by_arrival_time(Process processes[], int n)
+// Shortest Remaining Time First (SRTF) Scheduling
+// Preemptive SJF. The running process is only reconsidered when a process
+// arrives, since nothing else can change which job has the least time
+// left; between arrivals it runs straight to the next arrival or to its
+// completion.
+void srtf_scheduling(Process processes[], int n)
 {
-    for (int i = 0; i < n - 1; i++)
+    long long total_waiting_time = 0, total_turnaround_time = 0;
+    int preemptions = 0;
+
+    if (n <= 0)
+    {
+        return;
+    }
+
+    Process *temp_processes = malloc(sizeof(Process) * n);
+    int *ready_heap = malloc(sizeof(int) * n);
+    if (temp_processes == NULL || ready_heap == NULL)
+    {
+        printf("Error: Memory allocation failed!\n");
+        free(temp_processes);
+        free(ready_heap);
+        return;
+    }
+
+    // Create a copy of original processes
+    for (int i = 0; i < n; i++)
+    {
+        temp_processes[i] = processes[i];
+        temp_processes[i].remaining_time = processes[i].burst_time;
+    }
+
+    // Sort processes by arrival time
+    sort_by_arrival_time(temp_processes, n);
+
+    int current_time = 0;
+    int next_arrival = 0; // First process not yet admitted
+    int ready_count = 0;
+    int running = -1;     // Process on the CPU, -1 when idle
+    int completed_count = 0;
+
+    while (completed_count < n)
     {
-        for (int j = 0; j < n - i - 1; j++)
+        if (running == -1)
+        {
+            // If no process is available, skip ahead to the next arrival
+            if (ready_count == 0 && current_time < temp_processes[next_arrival].arrival_time)
+            {
+                current_time = temp_processes[next_arrival].arrival_time;
+            }
+
+            while (next_arrival < n && temp_processes[next_arrival].arrival_time <= current_time)
+            {
+                ready_heap_push(ready_heap, &ready_count, temp_processes, next_arrival++);
+            }
+
+            running = ready_heap_pop(ready_heap, &ready_count, temp_processes);
+        }
+
+        Process *current = &temp_processes[running];
+        int finish_time = current_time + current->remaining_time;
+
+        // Run until the next arrival, then let the new processes compete
+        if (next_arrival < n && temp_processes[next_arrival].arrival_time < finish_time)
         {
-            if (processes[j].arrival_time > processes[j + 1].arrival_time)
+            int arrival_time = temp_processes[next_arrival].arrival_time;
+            current->remaining_time -= arrival_time - current_time;
+            current_time = arrival_time;
+
+            while (next_arrival < n && temp_processes[next_arrival].arrival_time <= current_time)
             {
-                // Swap processes
-                Process temp = processes[j];
-                processes[j] = processes[j + 1];
-                processes[j + 1] = temp;
+                ready_heap_push(ready_heap, &ready_count, temp_processes, next_arrival++);
             }
+
+            // Preempt only for strictly less remaining time
+            int shortest = ready_heap[0];
+            if (temp_processes[shortest].remaining_time < current->remaining_time)
+            {
+                ready_heap_pop(ready_heap, &ready_count, temp_processes);
+                ready_heap_push(ready_heap, &ready_count, temp_processes, running);
+                running = shortest;
+                preemptions++;
+            }
+            continue;
         }
+
+        // Run the current process to completion
+        current_time = finish_time;
+        current->remaining_time = 0;
+        current->completion_time = current_time;
+        current->turnaround_time = current_time - current->arrival_time;
+        current->waiting_time = current->turnaround_time - current->burst_time;
+
+        total_waiting_time += current->waiting_time;
+        total_turnaround_time += current->turnaround_time;
+        completed_count++;
+        running = -1;
+    }
+
+    // Copy back to original processes
+    for (int i = 0; i < n; i++)
+    {
+        processes[i] = temp_processes[i];
     }
+    free(temp_processes);
+    free(ready_heap);
+
+    // Print SRTF results
+    printf("\n--- Shortest Remaining Time First (SRTF) Scheduling Results ---\n");
+    display_process_details(processes, n);
+
+    // Every process is dispatched once plus once more per preemption; each
+    // dispatch after the first replaces another process
+    printf("\nSRTF Scheduling Metrics:\n");
+    printf("Average Waiting Time: %.2f\n", (double)total_waiting_time / n);
+    printf("Average Turnaround Time: %.2f\n", (double)total_turnaround_time / n);
+    printf("Preemptions: %d\n", preemptions);
+    printf("Context Switches: %d\n", n + preemptions - 1);
 }
 
-// Sort processes by burst time
-void sort_by_burst_time(Process processes[], int n)
+// Add a ready process to the SJF heap
+void ready_heap_push(int heap[], int *size, const Process processes[], int index)
 {
-    for (int i = 0; i < n - 1; i++)
+    int pos = (*size)++;
+    while (pos > 0)
     {
-        for (int j = 0; j < n - i - 1; j++)
+        int parent = (pos - 1) / 2;
+        if (!runs_before(processes, index, heap[parent]))
         {
-            if (processes[j].burst_time > processes[j + 1].burst_time)
-            {
-                // Swap processes
-                Process temp = processes[j];
-                processes[j] = processes[j + 1];
-                processes[j + 1] = temp;
-            }
+            break;
+        }
+        heap[pos] = heap[parent];
+        pos = parent;
+    }
+    heap[pos] = index;
+}
+
+// Remove and return the ready process with the least remaining time
+int ready_heap_pop(int heap[], int *size, const Process processes[])
+{
+    int top = heap[0];
+    int last = heap[--(*size)];
+    int pos = 0;
+
+    for (;;)
+    {
+        int child = 2 * pos + 1;
+        if (child >= *size)
+        {
+            break;
+        }
+        if (child + 1 < *size && runs_before(processes, heap[child + 1], heap[child]))
+        {
+            child++;
+        }
+        if (!runs_before(processes, heap[child], last))
+        {
+            break;
         }
+        heap[pos] = heap[child];
+        pos = child;
     }
+    heap[pos] = last;
+    return top;
+}
+
+// Sort processes by arrival time
+void sort_by_arrival_time(Process processes[], int n)
+{
+    if (n < 2)
+    {
+        return;
+    }
+
+    int *keys = malloc(sizeof(int) * n);
+    if (keys == NULL)
+    {
+        printf("Error: Memory allocation failed!\n");
+        return;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        keys[i] = processes[i].arrival_time;
+    }
+
+    if (!sort_records_by_key(processes, sizeof(Process), keys, n))
+    {
+        printf("Error: Memory allocation failed!\n");
+    }
+    free(keys);
+}
+
+// Sort processes by burst time
+void sort_by_burst_time(Process processes[], int n)
+{
+    if (n < 2)
+    {
+        return;
+    }
+
+    int *keys = malloc(sizeof(int) * n);
+    if (keys == NULL)
+    {
+        printf("Error: Memory allocation failed!\n");
+        return;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        keys[i] = processes[i].burst_time;
+    }
+
+    if (!sort_records_by_key(processes, sizeof(Process), keys, n))
+    {
+        printf("Error: Memory allocation failed!\n");
+    }
+    free(keys);
 }
 
 // Display process details
@@ -202,11 +418,216 @@ void display_process_details(Process processes[], int n)
     }
 }
 
+// Policies the trace simulator can run
+typedef enum SchedulingPolicy
+{
+    POLICY_FCFS,
+    POLICY_SJF,
+    POLICY_SRTF
+} SchedulingPolicy;
+
+const char *policy_names[] = {"FCFS", "SJF", "SRTF"};
+const char *policy_options[] = {"fcfs", "sjf", "srtf"};
+#define NUM_POLICIES 3
+
+// Trace stream with the process slots and ready heap of SJF and SRTF
+typedef struct TraceSimulation
+{
+    TraceStream stream;
+    Process *slots;
+    int *ready_heap;
+} TraceSimulation;
+
+// Function to resize the process slots and the ready heap; returns 0 if
+// memory cannot be allocated
+int grow_trace_slots(void *context, int old_capacity, int capacity)
+{
+    TraceSimulation *sim = context;
+    (void)old_capacity;
+
+    Process *slots = realloc(sim->slots, sizeof(Process) * capacity);
+    if (slots != NULL)
+    {
+        sim->slots = slots;
+    }
+    int *ready_heap = realloc(sim->ready_heap, sizeof(int) * capacity);
+    if (ready_heap != NULL)
+    {
+        sim->ready_heap = ready_heap;
+    }
+    return slots != NULL && ready_heap != NULL;
+}
+
+// Function to fill a slot from a trace record and add it to the ready heap
+void admit_trace_process(void *context, int slot, int process_id, const TraceRecord *record)
+{
+    TraceSimulation *sim = context;
+    Process *process = &sim->slots[slot];
+
+    process->process_id = process_id;
+    process->arrival_time = record->arrival_time;
+    process->burst_time = record->burst_time;
+    process->remaining_time = record->burst_time;
+    ready_heap_push(sim->ready_heap, &sim->stream.ready_count, sim->slots, slot);
+}
+
+// Function to run a policy over the whole trace; returns 0 on error
+// FCFS needs no ready queue: processes run in trace order as they are
+// read. SJF and SRTF follow sjf_scheduling() and srtf_scheduling().
+int simulate_trace(TraceSimulation *sim, SchedulingPolicy policy)
+{
+    TraceStream *stream = &sim->stream;
+    TraceMetrics *metrics = &stream->metrics;
+    long long current_time = 0;
+    int running = -1; // Slot of the process on the CPU
+
+    if (!read_trace_record(stream))
+    {
+        return 0;
+    }
+
+    if (policy == POLICY_FCFS)
+    {
+        while (stream->has_next)
+        {
+            if (current_time < stream->next.arrival_time)
+            {
+                current_time = stream->next.arrival_time;
+            }
+            current_time += stream->next.burst_time;
+            record_dispatch(metrics, ++stream->admitted);
+            record_completion(metrics, stream->next.arrival_time, stream->next.burst_time, current_time);
+
+            if (!read_trace_record(stream))
+            {
+                return 0;
+            }
+        }
+        return 1;
+    }
+
+    while (stream->has_next || stream->ready_count > 0 || running != -1)
+    {
+        if (running == -1)
+        {
+            // If no process is available, skip ahead to the next arrival
+            if (stream->ready_count == 0 && current_time < stream->next.arrival_time)
+            {
+                current_time = stream->next.arrival_time;
+            }
+            if (!admit_arrivals(stream, current_time))
+            {
+                return 0;
+            }
+
+            running = ready_heap_pop(sim->ready_heap, &stream->ready_count, sim->slots);
+            record_dispatch(metrics, sim->slots[running].process_id);
+        }
+
+        long long finish_time = current_time + sim->slots[running].remaining_time;
+
+        // Under SRTF, run until the next arrival and let it compete
+        if (policy == POLICY_SRTF && stream->has_next && stream->next.arrival_time < finish_time)
+        {
+            sim->slots[running].remaining_time -= (int)(stream->next.arrival_time - current_time);
+            current_time = stream->next.arrival_time;
+            if (!admit_arrivals(stream, current_time))
+            {
+                return 0;
+            }
+
+            int shortest = sim->ready_heap[0];
+            if (sim->slots[shortest].remaining_time < sim->slots[running].remaining_time)
+            {
+                ready_heap_pop(sim->ready_heap, &stream->ready_count, sim->slots);
+                ready_heap_push(sim->ready_heap, &stream->ready_count, sim->slots, running);
+                running = shortest;
+                metrics->preemptions++;
+                record_dispatch(metrics, sim->slots[running].process_id);
+            }
+            continue;
+        }
+
+        // Run the current process to completion and recycle its slot
+        current_time = finish_time;
+        record_completion(metrics, sim->slots[running].arrival_time, sim->slots[running].burst_time, current_time);
+        release_trace_slot(stream, running);
+        running = -1;
+    }
+    return 1;
+}
+
+// Function to run the streaming trace mode:
+// fcfs_sjf --trace <fcfs|sjf|srtf> <file>
+int run_trace_simulation(int argc, char *argv[])
+{
+    int policy = -1;
+    for (int i = 0; argc == 2 && i < NUM_POLICIES; i++)
+    {
+        if (strcmp(argv[0], policy_options[i]) == 0)
+        {
+            policy = i;
+        }
+    }
+    if (policy == -1)
+    {
+        printf("Usage: fcfs_sjf --trace <fcfs|sjf|srtf> <file>\n");
+        return 1;
+    }
+
+    TraceSimulation sim;
+    memset(&sim, 0, sizeof(sim));
+    TraceHooks hooks = {grow_trace_slots, admit_trace_process, &sim};
+    if (!open_trace_stream(&sim.stream, argv[1], hooks))
+    {
+        return 1;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int ok = simulate_trace(&sim, (SchedulingPolicy)policy);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    close_trace_stream(&sim.stream);
+    free(sim.slots);
+    free(sim.ready_heap);
+    if (!ok)
+    {
+        return 1;
+    }
+
+    const TraceMetrics *metrics = &sim.stream.metrics;
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    printf("\n--- %s Trace Simulation: %s ---\n", policy_names[policy], argv[1]);
+    if (!print_trace_metrics(metrics))
+    {
+        return 0;
+    }
+    if (policy == POLICY_SRTF)
+    {
+        printf("Preemptions: %lld\n", metrics->preemptions);
+    }
+    if (policy != POLICY_FCFS)
+    {
+        printf("Peak Ready Queue: %d\n", metrics->peak_ready);
+    }
+    print_trace_timing(metrics, seconds);
+    return 0;
+}
+
 // Main function to demonstrate scheduling
-int main()
+int main(int argc, char *argv[])
 {
+    // Streaming trace mode
+    if (argc > 1 && strcmp(argv[1], "--trace") == 0)
+    {
+        return run_trace_simulation(argc - 2, argv + 2);
+    }
+
     Process fcfs_processes[MAX_PROCESSES];
     Process sjf_processes[MAX_PROCESSES];
+    Process srtf_processes[MAX_PROCESSES];
     int n;
 
     // Input process details
@@ -230,6 +651,8 @@ int main()
         printf("Burst Time: ");
         scanf("%d", &fcfs_processes[i].burst_time);
         sjf_processes[i].burst_time = fcfs_processes[i].burst_time;
+
+        srtf_processes[i] = sjf_processes[i];
     }
 
     // Perform FCFS Scheduling
@@ -238,5 +661,8 @@ int main()
     // Perform SJF Scheduling
     sjf_scheduling(sjf_processes, n);
 
+    // Perform SRTF Scheduling
+    srtf_scheduling(srtf_processes, n);
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,2605 @@
+#define _DEFAULT_SOURCE // MAP_ANONYMOUS and MAP_NORESERVE under -std=c11
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <pthread.h>
+
+#define BLOCK_CHUNK_BITS 10   // The block table grows 1024 entries at a time
+#define BLOCK_CHUNK_SIZE (1 << BLOCK_CHUNK_BITS)
+#define ARENA_SIZE (64 << 20) // Bytes reserved for the pool
+#define ARENA_ALIGN 16        // Alignment of regions and arena_malloc() sizes
+#define BLOCK_MAP_MIN_BITS 8  // The offset map starts with 2^8 slots
+
+// Structure to represent a memory block
+// Blocks of one region are linked in address order; splitting an
+// allocation adds a block after it and freeing merges free neighbours.
+typedef struct MemoryBlock
+{
+    int id;           // Block identifier, -1 for an unused table slot
+    int offset;       // Start address of the block in the pool
+    int size;         // Size of the block
+    int is_allocated; // Flag to check if block is allocated
+    int prev;         // Previous block in address order, -1 at region start
+    int next;         // Next block in address order, -1 at region end
+    int region;       // Index of the region the block was carved from
+} MemoryBlock;
+
+// Node of the free-block index, stored alongside each block
+typedef struct FreeNode
+{
+    int left;              // Child with smaller (size, id), or -1
+    int right;             // Child with larger (size, id), or -1
+    unsigned int priority; // Heap priority keeping the treap balanced
+} FreeNode;
+
+// The block table grows by whole chunks that never move, so block ids stay
+// valid and growing copies nothing but the chunk directory
+typedef struct BlockChunk
+{
+    MemoryBlock blocks[BLOCK_CHUNK_SIZE];
+    FreeNode nodes[BLOCK_CHUNK_SIZE];
+} BlockChunk;
+
+#define BLOCK(i) (block_chunks[(i) >> BLOCK_CHUNK_BITS]->blocks[(i) & (BLOCK_CHUNK_SIZE - 1)])
+#define FREE_NODE(i) (block_chunks[(i) >> BLOCK_CHUNK_BITS]->nodes[(i) & (BLOCK_CHUNK_SIZE - 1)])
+
+// Placement policies sharing the allocator core
+typedef enum PlacementPolicy
+{
+    FIRST_FIT, // Lowest-addressed block that fits
+    NEXT_FIT,  // First fit resuming where the previous search stopped
+    BEST_FIT,  // Smallest block that fits
+    WORST_FIT  // Largest block, if it fits
+} PlacementPolicy;
+
+const char *policy_names[] = {"First fit", "Next fit", "Best fit", "Worst fit"};
+const char *policy_options[] = {"first", "next", "best", "worst"};
+#define NUM_POLICIES 4
+
+PlacementPolicy placement_policy = BEST_FIT;
+
+// Outcome of a quiet allocation
+typedef enum AllocationStatus
+{
+    ALLOCATION_OK,
+    ALLOCATION_NO_FIT,       // No free block is large enough
+    ALLOCATION_INVALID_SIZE, // Size must be positive
+    ALLOCATION_NO_MEMORY     // The block map could not grow
+} AllocationStatus;
+
+typedef struct AllocationResult
+{
+    AllocationStatus status;
+    int block_id; // Allocated block, -1 on failure
+    int offset;
+    int size;
+} AllocationResult;
+
+// Outcome of a quiet free
+typedef enum FreeStatus
+{
+    FREE_OK,
+    FREE_ALREADY_FREE,
+    FREE_INVALID_BLOCK
+} FreeStatus;
+
+typedef struct FreeResult
+{
+    FreeStatus status;
+    int offset; // Offset and size of the block as it was freed
+    int size;
+} FreeResult;
+
+// Counters of the block-table allocator
+// Updated on the hot path without any I/O; read them with
+// get_allocator_stats() or print them with dump_allocator_stats().
+typedef struct AllocatorStats
+{
+    long allocations;        // Successful allocations
+    long frees;              // Successful frees
+    long failed_allocations; // Requests no free block could serve
+    long bytes_in_use;       // Sum of allocated block sizes
+    long search_steps;       // Blocks or tree nodes visited by lookups
+    int largest_free;        // Largest free block, filled in on query
+} AllocatorStats;
+
+AllocatorStats allocator_stats;
+
+// Block table: total_blocks entries spread over num_chunks chunks
+BlockChunk **block_chunks = NULL;
+int num_chunks = 0;
+int chunk_capacity = 0; // Slots in the chunk directory
+int total_blocks = 0;
+
+// Table slots released by coalescing, linked through their `next` field
+// and reused before new ones
+int unused_head = -1;
+
+// First block of every region added with add_memory_block(), in address
+// order; the first block of a region never moves
+int *region_heads = NULL;
+int region_capacity = 0;
+int total_regions = 0;
+int pool_end = 0;
+
+// Roving pointer of next fit: the next search starts at this block
+int rover = -1;
+
+// Backing memory for every region; a block's bytes start at arena + offset
+// while its header stays in the block table
+unsigned char *arena = NULL;
+
+// Open-addressed map from the offset of an allocated block to its index,
+// so arena_free() can find the header of a pointer; -1 marks empty slots.
+// It doubles whenever it would become more than half full.
+int *block_map = NULL;
+int block_map_bits = 0;
+int block_map_mask = 0;
+int block_map_count = 0;
+
+// Thread caches
+// Each thread keeps magazines of small blocks per size class and moves
+// them to and from the shared pool in batches, taking pool_lock once per
+// batch. The pool sees cached blocks as allocated until the thread flushes
+// them, which a thread-specific key destructor does when the thread exits.
+#define TCACHE_CLASSES 16 // Size classes of 16, 32, ... 256 bytes
+#define TCACHE_MAX_SIZE (TCACHE_CLASSES * ARENA_ALIGN)
+#define TCACHE_CAPACITY 32 // Blocks a thread keeps per class
+#define TCACHE_BATCH 16    // Blocks moved per refill or flush
+
+typedef struct ThreadCache
+{
+    void *blocks[TCACHE_CLASSES][TCACHE_CAPACITY];
+    int count[TCACHE_CLASSES];
+    int registered; // Exit destructor armed for this thread
+} ThreadCache;
+
+_Thread_local ThreadCache thread_cache;
+pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_key_t thread_cache_key;
+pthread_once_t thread_cache_key_once = PTHREAD_ONCE_INIT;
+
+// Size class + 1 of the cached block starting at each 16-byte unit of the
+// arena, 0 for blocks that bypass the caches; kept out of line so a free
+// on any thread finds the class without touching the pool
+unsigned char *unit_class = NULL;
+
+// Binary buddy allocator state
+// A second allocator mode carving one power-of-two region of the arena.
+// Blocks of order k are 2^k bytes at offsets aligned to 2^k, and a block's
+// buddy differs from it only in bit k. Like the block table, all
+// metadata is out of line, indexed by 16-byte unit.
+#define BUDDY_MIN_ORDER 4  // Smallest block: 16 bytes, one unit
+#define BUDDY_MAX_ORDER 26 // Largest pool: the whole arena
+
+int buddy_order = 0;                        // Pool is 2^buddy_order bytes, 0 if unset
+int buddy_base = 0;                         // Arena offset of the pool
+int buddy_free_head[BUDDY_MAX_ORDER + 1];   // Free list of each order, -1 if empty
+int *buddy_next = NULL;                     // Free-list links, by first unit
+int *buddy_prev = NULL;
+unsigned char *buddy_alloc_order = NULL;    // Order of the allocated block at a unit, 0 if none
+uint64_t *buddy_free_map[BUDDY_MAX_ORDER + 1]; // Bit per block of each order, set while free
+unsigned int buddy_nonempty = 0;            // Bit k set while order k has free blocks
+long buddy_free_bytes = 0;
+
+// Free blocks are kept in a treap ordered by (size, id), so the best fit
+// is the smallest key whose size covers the request
+int free_root = -1;
+int size_tree_active = 1; // Only maintained while best or worst fit runs
+unsigned int treap_seed = 2463534242u;
+
+// Function to size the offset map to 2^bits empty slots
+int reset_block_map(int bits)
+{
+    int *map = malloc(sizeof(int) << bits);
+    if (map == NULL)
+    {
+        return 0;
+    }
+
+    memset(map, 0xff, sizeof(int) << bits); // Every slot -1
+    free(block_map);
+    block_map = map;
+    block_map_bits = bits;
+    block_map_mask = (1 << bits) - 1;
+    block_map_count = 0;
+    return 1;
+}
+
+// Function to initialize memory blocks
+// Table chunks are kept for reuse; entries are set up as they are taken,
+// so resetting costs nothing per block.
+void initialize_memory()
+{
+    total_blocks = 0;
+    unused_head = -1;
+    rover = -1;
+    memset(&allocator_stats, 0, sizeof(allocator_stats));
+    total_regions = 0;
+    if (unit_class != NULL)
+    {
+        memset(unit_class, 0, pool_end / ARENA_ALIGN);
+    }
+    pool_end = 0;
+    buddy_order = 0;
+    free_root = -1;
+
+    // Shrink the offset map, or empty the one there is if that fails
+    if (!reset_block_map(BLOCK_MAP_MIN_BITS))
+    {
+        if (block_map == NULL)
+        {
+            printf("Error: Could not allocate the block map!\n");
+            return;
+        }
+        memset(block_map, 0xff, sizeof(int) << block_map_bits);
+        block_map_count = 0;
+    }
+
+    // Reserve the arena once; pages are only committed when touched
+    if (arena == NULL)
+    {
+        void *memory = mmap(NULL, ARENA_SIZE, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (memory == MAP_FAILED)
+        {
+            printf("Error: Could not map the memory arena!\n");
+            return;
+        }
+        arena = memory;
+
+        memory = mmap(NULL, ARENA_SIZE / ARENA_ALIGN, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (memory == MAP_FAILED)
+        {
+            printf("Error: Could not map the size class table!\n");
+            return;
+        }
+        unit_class = memory;
+    }
+}
+
+// Ordering of the free tree: by size, ties broken by block index
+int free_key_less(int a, int b)
+{
+    if (BLOCK(a).size != BLOCK(b).size)
+    {
+        return BLOCK(a).size < BLOCK(b).size;
+    }
+    return a < b;
+}
+
+// Join two treaps where every key in `left` is below every key in `right`
+int merge_free_trees(int left, int right)
+{
+    if (left == -1)
+    {
+        return right;
+    }
+    if (right == -1)
+    {
+        return left;
+    }
+
+    if (FREE_NODE(left).priority > FREE_NODE(right).priority)
+    {
+        FREE_NODE(left).right = merge_free_trees(FREE_NODE(left).right, right);
+        return left;
+    }
+    FREE_NODE(right).left = merge_free_trees(left, FREE_NODE(right).left);
+    return right;
+}
+
+// Function to add a block to the free index
+int insert_free_block(int root, int block)
+{
+    if (root == -1 || FREE_NODE(block).priority > FREE_NODE(root).priority)
+    {
+        // Split the subtree around the new key and hang both halves below it
+        int *left_slot = &FREE_NODE(block).left;
+        int *right_slot = &FREE_NODE(block).right;
+        while (root != -1)
+        {
+            if (free_key_less(root, block))
+            {
+                *left_slot = root;
+                left_slot = &FREE_NODE(root).right;
+                root = FREE_NODE(root).right;
+            }
+            else
+            {
+                *right_slot = root;
+                right_slot = &FREE_NODE(root).left;
+                root = FREE_NODE(root).left;
+            }
+        }
+        *left_slot = -1;
+        *right_slot = -1;
+        return block;
+    }
+
+    if (free_key_less(block, root))
+    {
+        FREE_NODE(root).left = insert_free_block(FREE_NODE(root).left, block);
+    }
+    else
+    {
+        FREE_NODE(root).right = insert_free_block(FREE_NODE(root).right, block);
+    }
+    return root;
+}
+
+// Function to remove a block from the free index
+int remove_free_block(int root, int block)
+{
+    if (root == block)
+    {
+        return merge_free_trees(FREE_NODE(root).left, FREE_NODE(root).right);
+    }
+
+    if (free_key_less(block, root))
+    {
+        FREE_NODE(root).left = remove_free_block(FREE_NODE(root).left, block);
+    }
+    else
+    {
+        FREE_NODE(root).right = remove_free_block(FREE_NODE(root).right, block);
+    }
+    return root;
+}
+
+// Function to add a free block to the size tree, if it is maintained
+void index_free_block(int block)
+{
+    if (size_tree_active)
+    {
+        free_root = insert_free_block(free_root, block);
+    }
+}
+
+// Function to drop a block from the size tree, if it is maintained
+void unindex_free_block(int block)
+{
+    if (size_tree_active)
+    {
+        free_root = remove_free_block(free_root, block);
+    }
+}
+
+// Best fit lookup in O(log n): the smallest free block that is large enough
+int find_best_fit(int request_size)
+{
+    int best_fit_index = -1;
+    int node = free_root;
+    long steps = 0;
+
+    while (node != -1)
+    {
+        steps++;
+        if (BLOCK(node).size >= request_size)
+        {
+            best_fit_index = node;
+            node = FREE_NODE(node).left;
+        }
+        else
+        {
+            node = FREE_NODE(node).right;
+        }
+    }
+    allocator_stats.search_steps += steps;
+    return best_fit_index;
+}
+
+// Worst fit lookup in O(log n): the largest free block, if it is enough
+int find_worst_fit(int request_size)
+{
+    int node = free_root;
+    if (node == -1)
+    {
+        return -1;
+    }
+
+    long steps = 1;
+    while (FREE_NODE(node).right != -1)
+    {
+        node = FREE_NODE(node).right;
+        steps++;
+    }
+    allocator_stats.search_steps += steps;
+    return BLOCK(node).size >= request_size ? node : -1;
+}
+
+// Next block in address order, wrapping from the last region to the first
+int next_in_address_order(int index)
+{
+    if (BLOCK(index).next != -1)
+    {
+        return BLOCK(index).next;
+    }
+
+    int region = BLOCK(index).region + 1;
+    return region_heads[region < total_regions ? region : 0];
+}
+
+// First fit lookup: the lowest-addressed free block that is large enough
+int find_first_fit(int request_size)
+{
+    long steps = 0;
+
+    for (int r = 0; r < total_regions; r++)
+    {
+        for (int i = region_heads[r]; i != -1; i = BLOCK(i).next)
+        {
+            // Check if block is free and has enough size
+            steps++;
+            if (!BLOCK(i).is_allocated && BLOCK(i).size >= request_size)
+            {
+                allocator_stats.search_steps += steps;
+                return i;
+            }
+        }
+    }
+    allocator_stats.search_steps += steps;
+    return -1;
+}
+
+// Next fit lookup: one lap over the pool in address order from the rover
+int find_next_fit(int request_size)
+{
+    if (total_regions == 0)
+    {
+        return -1;
+    }
+
+    int start = rover != -1 ? rover : region_heads[0];
+    int i = start;
+    long steps = 0;
+    do
+    {
+        steps++;
+        if (!BLOCK(i).is_allocated && BLOCK(i).size >= request_size)
+        {
+            allocator_stats.search_steps += steps;
+            rover = i;
+            return i;
+        }
+        i = next_in_address_order(i);
+    } while (i != start);
+
+    allocator_stats.search_steps += steps;
+    return -1;
+}
+
+// Reference best fit: linear scan over every block, kept for verification
+int scan_best_fit(int request_size)
+{
+    int best_fit_index = -1;
+    int min_difference = INT_MAX;
+
+    for (int i = 0; i < total_blocks; i++)
+    {
+        // Check if block is free and has enough size
+        if (BLOCK(i).id != -1 && !BLOCK(i).is_allocated &&
+            BLOCK(i).size >= request_size)
+        {
+            int current_difference = BLOCK(i).size - request_size;
+
+            // Update best fit if current block is a better match
+            if (current_difference < min_difference)
+            {
+                min_difference = current_difference;
+                best_fit_index = i;
+            }
+        }
+    }
+    return best_fit_index;
+}
+
+// Reference worst fit: linear scan, ties going to the highest index like
+// the tree's rightmost node
+int scan_worst_fit(int request_size)
+{
+    int worst_fit_index = -1;
+
+    for (int i = 0; i < total_blocks; i++)
+    {
+        if (BLOCK(i).id != -1 && !BLOCK(i).is_allocated &&
+            (worst_fit_index == -1 || BLOCK(i).size >= BLOCK(worst_fit_index).size))
+        {
+            worst_fit_index = i;
+        }
+    }
+    if (worst_fit_index != -1 && BLOCK(worst_fit_index).size < request_size)
+    {
+        return -1;
+    }
+    return worst_fit_index;
+}
+
+// Function to add one chunk to the block table
+int add_block_chunk()
+{
+    if (num_chunks == chunk_capacity)
+    {
+        int capacity = chunk_capacity > 0 ? chunk_capacity * 2 : 8;
+        BlockChunk **directory = realloc(block_chunks, sizeof(BlockChunk *) * capacity);
+        if (directory == NULL)
+        {
+            return 0;
+        }
+        block_chunks = directory;
+        chunk_capacity = capacity;
+    }
+
+    BlockChunk *chunk = malloc(sizeof(BlockChunk));
+    if (chunk == NULL)
+    {
+        return 0;
+    }
+    block_chunks[num_chunks++] = chunk;
+    return 1;
+}
+
+// Function to make room for `count` more table entries
+int reserve_blocks(int count)
+{
+    while ((long)num_chunks * BLOCK_CHUNK_SIZE < (long)total_blocks + count)
+    {
+        if (!add_block_chunk())
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Function to make room for `count` regions in the region directory
+int reserve_regions(int count)
+{
+    if (count <= region_capacity)
+    {
+        return 1;
+    }
+
+    int capacity = region_capacity > 0 ? region_capacity : 16;
+    while (capacity < count)
+    {
+        capacity *= 2;
+    }
+    int *heads = realloc(region_heads, sizeof(int) * capacity);
+    if (heads == NULL)
+    {
+        return 0;
+    }
+    region_heads = heads;
+    region_capacity = capacity;
+    return 1;
+}
+
+// Function to take a table slot for a new block, -1 if the table cannot
+// grow
+int take_block_slot()
+{
+    int index;
+    if (unused_head != -1)
+    {
+        index = unused_head;
+        unused_head = BLOCK(index).next;
+    }
+    else if (reserve_blocks(1))
+    {
+        index = total_blocks++;
+    }
+    else
+    {
+        return -1;
+    }
+
+    // xorshift priority for the block's tree node
+    treap_seed ^= treap_seed << 13;
+    treap_seed ^= treap_seed >> 17;
+    treap_seed ^= treap_seed << 5;
+    FREE_NODE(index).priority = treap_seed;
+    return index;
+}
+
+// Function to return a merged-away block's slot to the table
+void release_block_slot(int index)
+{
+    BLOCK(index).id = -1;
+    BLOCK(index).size = 0;
+    BLOCK(index).prev = -1;
+    BLOCK(index).region = -1;
+    BLOCK(index).next = unused_head;
+    unused_head = index;
+}
+
+// Function to unlink `index` from address order and fold it into `into`,
+// its free lower neighbour; neither may be in the free tree
+void absorb_block(int into, int index)
+{
+    int next = BLOCK(index).next;
+
+    BLOCK(into).size += BLOCK(index).size;
+    BLOCK(into).next = next;
+    if (next != -1)
+    {
+        BLOCK(next).prev = into;
+    }
+    if (rover == index)
+    {
+        rover = into;
+    }
+    release_block_slot(index);
+}
+
+// Function to cut a block down to `request_size`, indexing the rest as a
+// free block right after it; the block is used whole if no slot is left
+void split_block(int index, int request_size)
+{
+    int remainder = BLOCK(index).size - request_size;
+    if (remainder == 0)
+    {
+        return;
+    }
+
+    int rest = take_block_slot();
+    if (rest == -1)
+    {
+        return;
+    }
+
+    int next = BLOCK(index).next;
+    BLOCK(rest).id = rest;
+    BLOCK(rest).offset = BLOCK(index).offset + request_size;
+    BLOCK(rest).size = remainder;
+    BLOCK(rest).is_allocated = 0;
+    BLOCK(rest).prev = index;
+    BLOCK(rest).next = next;
+    BLOCK(rest).region = BLOCK(index).region;
+    if (next != -1)
+    {
+        BLOCK(next).prev = rest;
+    }
+
+    BLOCK(index).size = request_size;
+    BLOCK(index).next = rest;
+    index_free_block(rest);
+}
+
+// Home slot of an offset in the block map (Fibonacci hashing)
+int block_map_slot(int offset)
+{
+    return (int)(((uint32_t)offset * 2654435769u) >> (32 - block_map_bits));
+}
+
+// Function to record an allocated block in the block map; the caller has
+// reserved a slot with reserve_block_map_slot()
+void block_map_insert(int index)
+{
+    block_map_count++;
+    int slot = block_map_slot(BLOCK(index).offset);
+    while (block_map[slot] != -1)
+    {
+        slot = (slot + 1) & block_map_mask;
+    }
+    block_map[slot] = index;
+}
+
+// Function to make room in the block map for one more block, doubling it
+// before it gets more than half full; returns 0 if it cannot grow, leaving
+// the map as it was
+int reserve_block_map_slot()
+{
+    if (2 * (block_map_count + 1) <= block_map_mask + 1)
+    {
+        return 1;
+    }
+
+    int *old_map = block_map;
+    int old_size = block_map_mask + 1;
+
+    block_map = NULL;
+    if (!reset_block_map(block_map_bits + 1))
+    {
+        block_map = old_map;
+        return 0;
+    }
+    for (int slot = 0; slot < old_size; slot++)
+    {
+        if (old_map[slot] != -1)
+        {
+            block_map_insert(old_map[slot]);
+        }
+    }
+    free(old_map);
+    return 1;
+}
+
+// Function to find the allocated block starting at offset, -1 if none
+int block_map_find(int offset)
+{
+    for (int slot = block_map_slot(offset); block_map[slot] != -1;
+         slot = (slot + 1) & block_map_mask)
+    {
+        if (BLOCK(block_map[slot]).offset == offset)
+        {
+            return block_map[slot];
+        }
+    }
+    return -1;
+}
+
+// Function to drop a block from the block map
+// Later entries of the probe run are shifted back so lookups never stop
+// at the hole.
+void block_map_remove(int index)
+{
+    int slot = block_map_slot(BLOCK(index).offset);
+    while (block_map[slot] != index)
+    {
+        slot = (slot + 1) & block_map_mask;
+    }
+
+    block_map_count--;
+    int hole = slot;
+    for (;;)
+    {
+        slot = (slot + 1) & block_map_mask;
+        if (block_map[slot] == -1)
+        {
+            break;
+        }
+
+        // Move the entry if its home slot is not in (hole, slot]
+        int home = block_map_slot(BLOCK(block_map[slot]).offset);
+        if (((slot - home) & block_map_mask) >= ((slot - hole) & block_map_mask))
+        {
+            block_map[hole] = block_map[slot];
+            hole = slot;
+        }
+    }
+    block_map[hole] = -1;
+}
+
+// Function to register a region as a free block; returns its index, or
+// -1 if the arena or the table cannot take it
+int register_region(int size)
+{
+    if (arena == NULL || size <= 0 || size > ARENA_SIZE - pool_end ||
+        !reserve_regions(total_regions + 1))
+    {
+        return -1;
+    }
+
+    int index = take_block_slot();
+    if (index == -1)
+    {
+        return -1;
+    }
+
+    // Each region starts where the previous one ended but never merges
+    // with it, so region boundaries stay block boundaries
+    BLOCK(index).id = index;
+    BLOCK(index).offset = pool_end;
+    BLOCK(index).size = size;
+    BLOCK(index).is_allocated = 0;
+    BLOCK(index).prev = -1;
+    BLOCK(index).next = -1;
+    BLOCK(index).region = total_regions;
+    region_heads[total_regions++] = index;
+    pool_end += (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+    index_free_block(index);
+    return index;
+}
+
+// Function to add a memory block
+void add_memory_block(int size)
+{
+    if (register_region(size) == -1)
+    {
+        printf("Memory pool cannot hold a block of size %d.\n", size);
+    }
+}
+
+// Function to add many memory blocks at once
+// Table chunks and region slots are reserved in one step; returns how many
+// blocks were added, stopping at the first one that does not fit.
+int add_memory_blocks(const int sizes[], int count)
+{
+    if (count <= 0 || !reserve_blocks(count) || !reserve_regions(total_regions + count))
+    {
+        return 0;
+    }
+
+    for (int k = 0; k < count; k++)
+    {
+        if (register_region(sizes[k]) == -1)
+        {
+            return k;
+        }
+    }
+    return count;
+}
+
+// Function to claim a free block for a request, splitting off the rest;
+// returns 0, leaving the block free, if the block map cannot grow
+int claim_block(int index, int request_size)
+{
+    if (!reserve_block_map_slot())
+    {
+        return 0;
+    }
+
+    unindex_free_block(index);
+    split_block(index, request_size);
+    BLOCK(index).is_allocated = 1;
+    block_map_insert(index);
+
+    allocator_stats.allocations++;
+    allocator_stats.bytes_in_use += BLOCK(index).size;
+    return 1;
+}
+
+// Function to return an allocated block, coalescing it with free
+// neighbours in address order; their sizes change, so they leave the free
+// tree first
+void release_block(int index)
+{
+    int merged = index;
+    int next = BLOCK(index).next;
+    int prev = BLOCK(index).prev;
+
+    block_map_remove(index);
+    BLOCK(index).is_allocated = 0;
+    allocator_stats.frees++;
+    allocator_stats.bytes_in_use -= BLOCK(index).size;
+    if (next != -1 && !BLOCK(next).is_allocated)
+    {
+        unindex_free_block(next);
+        absorb_block(merged, next);
+    }
+    if (prev != -1 && !BLOCK(prev).is_allocated)
+    {
+        unindex_free_block(prev);
+        absorb_block(prev, merged);
+        merged = prev;
+    }
+    index_free_block(merged);
+}
+
+// Function to pick a free block under the current placement policy
+// Best and worst fit use the size tree; with ALLOCATOR_VERIFY defined they
+// are checked against the linear scans, including ties.
+int find_block(int request_size)
+{
+    int index = -1;
+
+    switch (placement_policy)
+    {
+    case FIRST_FIT:
+        index = find_first_fit(request_size);
+        break;
+    case NEXT_FIT:
+        index = find_next_fit(request_size);
+        break;
+    case BEST_FIT:
+        index = find_best_fit(request_size);
+#ifdef ALLOCATOR_VERIFY
+        assert(index == scan_best_fit(request_size));
+#endif
+        break;
+    case WORST_FIT:
+        index = find_worst_fit(request_size);
+#ifdef ALLOCATOR_VERIFY
+        assert(index == scan_worst_fit(request_size));
+#endif
+        break;
+    }
+    return index;
+}
+
+// Function to switch placement policy
+// First and next fit walk address order, so the size tree is dropped
+// while they run and rebuilt from the free blocks on the way back.
+void set_placement_policy(PlacementPolicy policy)
+{
+    int needs_tree = policy == BEST_FIT || policy == WORST_FIT;
+
+    if (needs_tree && !size_tree_active)
+    {
+        free_root = -1;
+        for (int i = 0; i < total_blocks; i++)
+        {
+            if (BLOCK(i).id != -1 && !BLOCK(i).is_allocated)
+            {
+                free_root = insert_free_block(free_root, i);
+            }
+        }
+    }
+    size_tree_active = needs_tree;
+    placement_policy = policy;
+}
+
+// Function to parse a policy name given on the command line
+int parse_placement_policy(const char *name, PlacementPolicy *policy)
+{
+    for (int i = 0; i < NUM_POLICIES; i++)
+    {
+        if (strcmp(name, policy_options[i]) == 0)
+        {
+            *policy = (PlacementPolicy)i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Quiet allocation under the current placement policy
+AllocationResult allocate_block(int request_size)
+{
+    AllocationResult result = {ALLOCATION_INVALID_SIZE, -1, 0, 0};
+    if (request_size <= 0)
+    {
+        return result;
+    }
+
+    // Find a block under the placement policy
+    int index = find_block(request_size);
+    if (index == -1)
+    {
+        allocator_stats.failed_allocations++;
+        result.status = ALLOCATION_NO_FIT;
+        return result;
+    }
+
+    if (!claim_block(index, request_size))
+    {
+        allocator_stats.failed_allocations++;
+        result.status = ALLOCATION_NO_MEMORY;
+        return result;
+    }
+    result.status = ALLOCATION_OK;
+    result.block_id = index;
+    result.offset = BLOCK(index).offset;
+    result.size = BLOCK(index).size;
+    return result;
+}
+
+// Quiet free of a block returned by allocate_block()
+FreeResult free_block(int block_id)
+{
+    FreeResult result = {FREE_INVALID_BLOCK, 0, 0};
+    if (block_id < 0 || block_id >= total_blocks || BLOCK(block_id).id == -1)
+    {
+        return result;
+    }
+
+    result.offset = BLOCK(block_id).offset;
+    result.size = BLOCK(block_id).size;
+    if (!BLOCK(block_id).is_allocated)
+    {
+        result.status = FREE_ALREADY_FREE;
+        return result;
+    }
+
+    release_block(block_id);
+    result.status = FREE_OK;
+    return result;
+}
+
+// Memory allocation under the current placement policy, with a report
+int allocate_memory(int request_size)
+{
+    AllocationResult result = allocate_block(request_size);
+
+    if (result.status == ALLOCATION_OK)
+    {
+        printf("Memory allocated: Block ID %d, Offset %d, Size %d\n",
+               result.block_id, result.offset, result.size);
+        return result.block_id;
+    }
+
+    printf("No suitable memory block found for size %d\n", request_size);
+    return -1;
+}
+
+// Function to free allocated memory, with a report
+void free_memory(int block_id)
+{
+    FreeResult result = free_block(block_id);
+
+    switch (result.status)
+    {
+    case FREE_OK:
+        printf("Memory freed: Block ID %d, Offset %d, Size %d\n",
+               block_id, result.offset, result.size);
+        break;
+    case FREE_ALREADY_FREE:
+        printf("Block %d is already free\n", block_id);
+        break;
+    case FREE_INVALID_BLOCK:
+        printf("Invalid block ID\n");
+        break;
+    }
+}
+
+// Function to read the counters, including the current largest free block
+AllocatorStats get_allocator_stats()
+{
+    AllocatorStats stats = allocator_stats;
+
+    stats.largest_free = 0;
+    if (size_tree_active && free_root != -1)
+    {
+        int node = free_root;
+        while (FREE_NODE(node).right != -1)
+        {
+            node = FREE_NODE(node).right;
+        }
+        stats.largest_free = BLOCK(node).size;
+    }
+    else if (!size_tree_active)
+    {
+        for (int i = 0; i < total_blocks; i++)
+        {
+            if (BLOCK(i).id != -1 && !BLOCK(i).is_allocated &&
+                BLOCK(i).size > stats.largest_free)
+            {
+                stats.largest_free = BLOCK(i).size;
+            }
+        }
+    }
+    return stats;
+}
+
+// Function to print the counters, e.g. periodically from a caller's loop
+void dump_allocator_stats(FILE *out)
+{
+    AllocatorStats stats = get_allocator_stats();
+    long attempts = stats.allocations + stats.failed_allocations;
+
+    fprintf(out, "Allocations = %ld, Frees = %ld, Failed = %ld, In use = %ld bytes, "
+                 "Largest free = %d, Search steps = %ld (%.1f per request)\n",
+            stats.allocations, stats.frees, stats.failed_allocations, stats.bytes_in_use,
+            stats.largest_free, stats.search_steps,
+            attempts > 0 ? (double)stats.search_steps / attempts : 0.0);
+}
+
+// Function to get the arena bytes of a block
+void *block_address(int block_id)
+{
+    return arena + BLOCK(block_id).offset;
+}
+
+// malloc-shaped entry point: returns memory from the pool, or NULL
+// Sizes are rounded to ARENA_ALIGN, so results stay aligned as long as the
+// pool is carved only through arena_malloc().
+void *arena_malloc(size_t size)
+{
+    if (size == 0 || size > INT_MAX - ARENA_ALIGN)
+    {
+        return NULL;
+    }
+
+    int request_size = (int)((size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1));
+    int index = find_block(request_size);
+    if (index == -1)
+    {
+        allocator_stats.failed_allocations++;
+        return NULL;
+    }
+
+    if (!claim_block(index, request_size))
+    {
+        allocator_stats.failed_allocations++;
+        return NULL;
+    }
+    return arena + BLOCK(index).offset;
+}
+
+// free-shaped entry point; NULL and pointers not from arena_malloc() are
+// ignored
+void arena_free(void *ptr)
+{
+    if (ptr == NULL || arena == NULL)
+    {
+        return;
+    }
+
+    unsigned char *bytes = ptr;
+    if (bytes < arena || bytes >= arena + pool_end)
+    {
+        return;
+    }
+
+    int index = block_map_find((int)(bytes - arena));
+    if (index != -1)
+    {
+        release_block(index);
+    }
+}
+
+// Structure to summarise how the pool is used
+typedef struct PoolUsage
+{
+    int total_used;   // Units in allocated blocks
+    int total_free;   // Units in free blocks
+    int free_blocks;  // Number of free blocks
+    int largest_free; // Size of the largest free block
+} PoolUsage;
+
+// Function to measure the pool
+PoolUsage measure_pool_usage()
+{
+    PoolUsage usage = {0, 0, 0, 0};
+
+    for (int i = 0; i < total_blocks; i++)
+    {
+        if (BLOCK(i).id == -1)
+        {
+            continue;
+        }
+        if (BLOCK(i).is_allocated)
+        {
+            usage.total_used += BLOCK(i).size;
+            continue;
+        }
+        usage.free_blocks++;
+        usage.total_free += BLOCK(i).size;
+        if (BLOCK(i).size > usage.largest_free)
+        {
+            usage.largest_free = BLOCK(i).size;
+        }
+    }
+    return usage;
+}
+
+// External fragmentation in percent: the share of free space outside the
+// largest free block, 0% when all free space could serve one request
+double external_fragmentation(PoolUsage usage)
+{
+    if (usage.total_free == 0)
+    {
+        return 0.0;
+    }
+    return 100.0 * (usage.total_free - usage.largest_free) / usage.total_free;
+}
+
+// Function to report free space and external fragmentation
+void display_fragmentation()
+{
+    PoolUsage usage = measure_pool_usage();
+
+    printf("Used = %d, Free = %d in %d blocks, Largest free = %d, External fragmentation = %.1f%%\n",
+           usage.total_used, usage.total_free, usage.free_blocks, usage.largest_free,
+           external_fragmentation(usage));
+}
+
+// Function to display memory blocks
+void display_memory_status()
+{
+    printf("\nMemory Block Status:\n");
+    printf("---------------------\n");
+    for (int r = 0; r < total_regions; r++)
+    {
+        for (int i = region_heads[r]; i != -1; i = BLOCK(i).next)
+        {
+            printf("Block %d: Offset = %d, Size = %d, Status = %s\n",
+                   BLOCK(i).id,
+                   BLOCK(i).offset,
+                   BLOCK(i).size,
+                   BLOCK(i).is_allocated ? "Allocated" : "Free");
+        }
+    }
+    display_fragmentation();
+    printf("\n");
+}
+
+// Smallest order whose blocks hold `size` bytes
+int buddy_order_for(size_t size)
+{
+    int order = BUDDY_MIN_ORDER;
+    while (order <= BUDDY_MAX_ORDER && ((size_t)1 << order) < size)
+    {
+        order++;
+    }
+    return order;
+}
+
+// Bitmap position of the order-k block starting at `unit`
+uint64_t *buddy_map_word(int order, int unit, uint64_t *bit)
+{
+    int block = unit >> (order - BUDDY_MIN_ORDER);
+    *bit = (uint64_t)1 << (block & 63);
+    return &buddy_free_map[order][block >> 6];
+}
+
+// Function to put a block on its order's free list
+void buddy_push(int order, int unit)
+{
+    uint64_t bit;
+    *buddy_map_word(order, unit, &bit) |= bit;
+
+    buddy_prev[unit] = -1;
+    buddy_next[unit] = buddy_free_head[order];
+    if (buddy_free_head[order] != -1)
+    {
+        buddy_prev[buddy_free_head[order]] = unit;
+    }
+    buddy_free_head[order] = unit;
+    buddy_nonempty |= 1u << order;
+}
+
+// Function to take a block off its order's free list
+void buddy_unlink(int order, int unit)
+{
+    uint64_t bit;
+    *buddy_map_word(order, unit, &bit) &= ~bit;
+
+    if (buddy_prev[unit] != -1)
+    {
+        buddy_next[buddy_prev[unit]] = buddy_next[unit];
+    }
+    else
+    {
+        buddy_free_head[order] = buddy_next[unit];
+    }
+    if (buddy_next[unit] != -1)
+    {
+        buddy_prev[buddy_next[unit]] = buddy_prev[unit];
+    }
+    if (buddy_free_head[order] == -1)
+    {
+        buddy_nonempty &= ~(1u << order);
+    }
+}
+
+// Function to set up a buddy pool of 2^order bytes after the block table's
+// regions; returns 0 if the arena cannot hold it
+int initialize_buddy(int order)
+{
+    if (arena == NULL || order < BUDDY_MIN_ORDER || order > BUDDY_MAX_ORDER)
+    {
+        return 0;
+    }
+
+    int size = 1 << order;
+    int base = (pool_end + size - 1) & ~(size - 1);
+    if (base > ARENA_SIZE - size)
+    {
+        return 0;
+    }
+
+    int units = size >> BUDDY_MIN_ORDER;
+    size_t map_words = 0;
+    for (int k = BUDDY_MIN_ORDER; k <= order; k++)
+    {
+        map_words += ((size_t)(units >> (k - BUDDY_MIN_ORDER)) + 63) / 64;
+    }
+
+    free(buddy_next);
+    free(buddy_prev);
+    free(buddy_alloc_order);
+    free(buddy_free_map[BUDDY_MIN_ORDER]);
+    for (int k = 0; k <= BUDDY_MAX_ORDER; k++)
+    {
+        buddy_free_head[k] = -1;
+        buddy_free_map[k] = NULL;
+    }
+    buddy_order = 0;
+    buddy_nonempty = 0;
+    buddy_free_bytes = 0;
+
+    buddy_next = malloc(sizeof(int) * units);
+    buddy_prev = malloc(sizeof(int) * units);
+    buddy_alloc_order = calloc(units, 1);
+    uint64_t *words = calloc(map_words, sizeof(uint64_t));
+    if (buddy_next == NULL || buddy_prev == NULL || buddy_alloc_order == NULL || words == NULL)
+    {
+        printf("Error: Could not allocate buddy metadata!\n");
+        free(buddy_next);
+        free(buddy_prev);
+        free(buddy_alloc_order);
+        free(words);
+        buddy_next = NULL;
+        buddy_prev = NULL;
+        buddy_alloc_order = NULL;
+        return 0;
+    }
+
+    for (int k = BUDDY_MIN_ORDER; k <= order; k++)
+    {
+        buddy_free_map[k] = words;
+        words += ((size_t)(units >> (k - BUDDY_MIN_ORDER)) + 63) / 64;
+    }
+
+    buddy_order = order;
+    buddy_base = base;
+    buddy_nonempty = 0;
+    buddy_free_bytes = size;
+    pool_end = base + size;
+    buddy_push(order, 0);
+    return 1;
+}
+
+// Buddy allocation: split the smallest free block that is large enough
+void *buddy_malloc(size_t size)
+{
+    if (buddy_order == 0 || size == 0 || size > ((size_t)1 << buddy_order))
+    {
+        return NULL;
+    }
+
+    int order = buddy_order_for(size);
+    unsigned int candidates = buddy_nonempty & ~((1u << order) - 1);
+    if (candidates == 0)
+    {
+        return NULL;
+    }
+
+    int k = __builtin_ctz(candidates);
+    int unit = buddy_free_head[k];
+    buddy_unlink(k, unit);
+
+    // Hand the upper halves back until the block has the wanted order
+    while (k > order)
+    {
+        k--;
+        buddy_push(k, unit + (1 << (k - BUDDY_MIN_ORDER)));
+    }
+
+    buddy_alloc_order[unit] = (unsigned char)order;
+    buddy_free_bytes -= 1L << order;
+    return arena + buddy_base + ((size_t)unit << BUDDY_MIN_ORDER);
+}
+
+// free-shaped entry point for the buddy pool: merges the block with its
+// buddy for as long as the buddy is free at the same order; pointers that
+// do not start an allocated block are ignored
+void buddy_free(void *ptr)
+{
+    if (ptr == NULL || buddy_order == 0)
+    {
+        return;
+    }
+
+    long offset = (unsigned char *)ptr - (arena + buddy_base);
+    if (offset < 0 || offset >= (1L << buddy_order) || (offset & ((1 << BUDDY_MIN_ORDER) - 1)) != 0)
+    {
+        return;
+    }
+
+    int unit = (int)(offset >> BUDDY_MIN_ORDER);
+    int k = buddy_alloc_order[unit];
+    if (k == 0)
+    {
+        return;
+    }
+    buddy_alloc_order[unit] = 0;
+    buddy_free_bytes += 1L << k;
+
+    while (k < buddy_order)
+    {
+        int buddy = unit ^ (1 << (k - BUDDY_MIN_ORDER));
+        uint64_t bit;
+        if ((*buddy_map_word(k, buddy, &bit) & bit) == 0)
+        {
+            break;
+        }
+        buddy_unlink(k, buddy);
+        unit &= buddy;
+        k++;
+    }
+    buddy_push(k, unit);
+}
+
+// Function to measure the buddy pool in the block table's terms
+PoolUsage measure_buddy_usage()
+{
+    PoolUsage usage = {0, 0, 0, 0};
+
+    if (buddy_order == 0)
+    {
+        return usage;
+    }
+    for (int k = BUDDY_MIN_ORDER; k <= buddy_order; k++)
+    {
+        for (int unit = buddy_free_head[k]; unit != -1; unit = buddy_next[unit])
+        {
+            usage.free_blocks++;
+        }
+    }
+    usage.total_free = (int)buddy_free_bytes;
+    usage.total_used = (1 << buddy_order) - usage.total_free;
+    usage.largest_free = buddy_nonempty != 0 ? 1 << (31 - __builtin_clz(buddy_nonempty)) : 0;
+    return usage;
+}
+
+// Function to display the buddy free lists
+void display_buddy_status()
+{
+    printf("\nBuddy Pool Status (%d bytes):\n", 1 << buddy_order);
+    printf("---------------------\n");
+    for (int k = BUDDY_MIN_ORDER; k <= buddy_order; k++)
+    {
+        if (buddy_free_head[k] == -1)
+        {
+            continue;
+        }
+        printf("Order %d (%d bytes): free at", k, 1 << k);
+        for (int unit = buddy_free_head[k]; unit != -1; unit = buddy_next[unit])
+        {
+            printf(" %d", unit << BUDDY_MIN_ORDER);
+        }
+        printf("\n");
+    }
+
+    PoolUsage usage = measure_buddy_usage();
+    printf("Used = %d, Free = %d in %d blocks, Largest free = %d, External fragmentation = %.1f%%\n",
+           usage.total_used, usage.total_free, usage.free_blocks, usage.largest_free,
+           external_fragmentation(usage));
+    printf("\n");
+}
+
+// Locked entry points to the shared pool
+void *pool_malloc(size_t size)
+{
+    pthread_mutex_lock(&pool_lock);
+    void *ptr = arena_malloc(size);
+    pthread_mutex_unlock(&pool_lock);
+    return ptr;
+}
+
+void pool_free(void *ptr)
+{
+    pthread_mutex_lock(&pool_lock);
+    arena_free(ptr);
+    pthread_mutex_unlock(&pool_lock);
+}
+
+// Function to return `count` cached blocks of a class to the pool
+void flush_cache_class(ThreadCache *cache, int size_class, int count)
+{
+    pthread_mutex_lock(&pool_lock);
+    while (count-- > 0 && cache->count[size_class] > 0)
+    {
+        unsigned char *block = cache->blocks[size_class][--cache->count[size_class]];
+        unit_class[(block - arena) / ARENA_ALIGN] = 0;
+        arena_free(block);
+    }
+    pthread_mutex_unlock(&pool_lock);
+}
+
+// Function to hand every block of a thread cache back to the pool
+void flush_cache(ThreadCache *cache)
+{
+    for (int c = 0; c < TCACHE_CLASSES; c++)
+    {
+        if (cache->count[c] > 0)
+        {
+            flush_cache_class(cache, c, TCACHE_CAPACITY);
+        }
+    }
+}
+
+// Function to hand every block cached by the calling thread back to the
+// pool; call before the pool is re-initialized. Threads that exit flush
+// their caches on their own.
+void flush_thread_cache()
+{
+    flush_cache(&thread_cache);
+}
+
+// Destructor of thread_cache_key, run as a thread with cached blocks exits
+void release_thread_cache(void *cache)
+{
+    flush_cache(cache);
+    ((ThreadCache *)cache)->registered = 0;
+}
+
+// Function to create the key whose destructor flushes an exiting thread
+void create_thread_cache_key()
+{
+    pthread_key_create(&thread_cache_key, release_thread_cache);
+}
+
+// Function to arm the exit destructor before a thread first caches a block
+void register_thread_cache(ThreadCache *cache)
+{
+    pthread_once(&thread_cache_key_once, create_thread_cache_key);
+    pthread_setspecific(thread_cache_key, cache);
+    cache->registered = 1;
+}
+
+// Thread-safe malloc: small sizes come from the calling thread's cache,
+// larger ones from the locked pool
+void *tcache_malloc(size_t size)
+{
+    if (size == 0 || size > TCACHE_MAX_SIZE)
+    {
+        return size == 0 ? NULL : pool_malloc(size);
+    }
+
+    ThreadCache *cache = &thread_cache;
+    int size_class = (int)((size - 1) / ARENA_ALIGN);
+    if (cache->count[size_class] == 0)
+    {
+        if (!cache->registered)
+        {
+            register_thread_cache(cache);
+        }
+
+        // Refill a batch under one lock acquisition
+        pthread_mutex_lock(&pool_lock);
+        while (cache->count[size_class] < TCACHE_BATCH)
+        {
+            unsigned char *block = arena_malloc((size_t)(size_class + 1) * ARENA_ALIGN);
+            if (block == NULL)
+            {
+                break;
+            }
+            unit_class[(block - arena) / ARENA_ALIGN] = (unsigned char)(size_class + 1);
+            cache->blocks[size_class][cache->count[size_class]++] = block;
+        }
+        pthread_mutex_unlock(&pool_lock);
+
+        if (cache->count[size_class] == 0)
+        {
+            return NULL;
+        }
+    }
+    return cache->blocks[size_class][--cache->count[size_class]];
+}
+
+// Thread-safe free; a small block goes to the calling thread's cache,
+// whichever thread allocated it
+void tcache_free(void *ptr)
+{
+    if (ptr == NULL)
+    {
+        return;
+    }
+
+    int size_class = unit_class[((unsigned char *)ptr - arena) / ARENA_ALIGN] - 1;
+    if (size_class < 0)
+    {
+        pool_free(ptr);
+        return;
+    }
+
+    ThreadCache *cache = &thread_cache;
+    if (!cache->registered)
+    {
+        register_thread_cache(cache);
+    }
+    if (cache->count[size_class] == TCACHE_CAPACITY)
+    {
+        flush_cache_class(cache, size_class, TCACHE_BATCH);
+    }
+    cache->blocks[size_class][cache->count[size_class]++] = ptr;
+}
+
+// Monotonic clock in nanoseconds
+double now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Replay one alloc/free sequence through a malloc/free pair
+// Each operation frees whatever occupies a random live slot and fills it
+// with a new allocation; returns nanoseconds per operation. The last live
+// set and its requested sizes are left in place so the pool can be measured.
+double replay_allocations(void *(*alloc_fn)(size_t), void (*free_fn)(void *),
+                          const int sizes[], const int slots[], long operations,
+                          void *live[], int live_sizes[], long *failures)
+{
+    double start = now_ns();
+    for (long op = 0; op < operations; op++)
+    {
+        int slot = slots[op];
+        free_fn(live[slot]);
+        live[slot] = alloc_fn(sizes[op]);
+        live_sizes[slot] = live[slot] != NULL ? sizes[op] : 0;
+        if (live[slot] == NULL)
+        {
+            (*failures)++;
+            continue;
+        }
+        *(volatile unsigned char *)live[slot] = (unsigned char)op; // Touch the block
+    }
+    return (now_ns() - start) / operations;
+}
+
+// Function to free every live allocation after a replay
+void release_live(void (*free_fn)(void *), void *live[], int num_live)
+{
+    for (int k = 0; k < num_live; k++)
+    {
+        free_fn(live[k]);
+        live[k] = NULL;
+    }
+}
+
+// Internal fragmentation in percent: granted bytes beyond the requests
+double internal_fragmentation(int total_used, const int live_sizes[], int num_live)
+{
+    long requested = 0;
+    for (int k = 0; k < num_live; k++)
+    {
+        requested += live_sizes[k];
+    }
+    return total_used > 0 ? 100.0 * (total_used - requested) / total_used : 0.0;
+}
+
+// Run one trace through every placement policy, the buddy allocator and
+// the C library
+int run_allocator_benchmark(int argc, char *argv[])
+{
+    long operations = argc > 0 ? atol(argv[0]) : 1000000;
+    int num_live = argc > 1 ? atoi(argv[1]) : 32;
+    int max_size = argc > 2 ? atoi(argv[2]) : 512;
+
+    if (operations <= 0 || num_live <= 0 || max_size < ARENA_ALIGN ||
+        (long)num_live * (max_size + ARENA_ALIGN) > ARENA_SIZE / 2)
+    {
+        printf("Usage: memory_allocation --bench [operations] [live blocks] [max size >= %d]\n",
+               ARENA_ALIGN);
+        return 1;
+    }
+
+    int *sizes = malloc(sizeof(int) * operations);
+    int *slots = malloc(sizeof(int) * operations);
+    void **live = calloc(num_live, sizeof(void *));
+    int *live_sizes = calloc(num_live, sizeof(int));
+    unsigned int seed = 2463534242u;
+    for (long op = 0; op < operations; op++)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        sizes[op] = 1 + seed % max_size;
+        slots[op] = (seed >> 16) % num_live;
+    }
+
+    // Every pool gets room for each live block at its largest size
+    int pool_size = num_live * (max_size + ARENA_ALIGN);
+
+    printf("%-11s %10s %10s %10s %10s\n", "Allocator", "ns/op", "failed", "external", "internal");
+    for (int p = 0; p < NUM_POLICIES; p++)
+    {
+        initialize_memory();
+        set_placement_policy((PlacementPolicy)p);
+        add_memory_block(pool_size);
+
+        long failures = 0;
+        double ns = replay_allocations(arena_malloc, arena_free, sizes, slots, operations,
+                                       live, live_sizes, &failures);
+        PoolUsage usage = measure_pool_usage();
+        release_live(arena_free, live, num_live);
+
+        printf("%-11s %10.1f %10ld %9.1f%% %9.1f%%\n", policy_names[p], ns, failures,
+               external_fragmentation(usage),
+               internal_fragmentation(usage.total_used, live_sizes, num_live));
+    }
+
+    // The buddy pool is the next power of two, since blocks round up too
+    initialize_memory();
+    if (initialize_buddy(buddy_order_for(pool_size)))
+    {
+        long failures = 0;
+        double ns = replay_allocations(buddy_malloc, buddy_free, sizes, slots, operations,
+                                       live, live_sizes, &failures);
+        PoolUsage usage = measure_buddy_usage();
+        release_live(buddy_free, live, num_live);
+
+        printf("%-11s %10.1f %10ld %9.1f%% %9.1f%%\n", "Buddy", ns, failures,
+               external_fragmentation(usage),
+               internal_fragmentation(usage.total_used, live_sizes, num_live));
+    }
+
+    long failures = 0;
+    double ns = replay_allocations(malloc, free, sizes, slots, operations, live, live_sizes, &failures);
+    release_live(free, live, num_live);
+    printf("%-11s %10.1f %10ld %10s %10s\n", "libc malloc", ns, failures, "-", "-");
+
+    free(sizes);
+    free(slots);
+    free(live);
+    free(live_sizes);
+    return 0;
+}
+
+// Allocation traces
+// A trace is a sequence of "a <id> <size>" and "f <id>" lines; ids name
+// live allocations and may be reused once freed.
+typedef struct TraceOp
+{
+    int id;   // Allocation the operation refers to
+    int size; // Bytes to allocate, 0 to free
+} TraceOp;
+
+typedef struct AllocationTrace
+{
+    TraceOp *ops;
+    long count;
+    long capacity;
+    int num_ids;           // Ids run from 0 to num_ids - 1
+    long allocations;      // Operations that allocate
+    long peak_live_bytes;  // Largest sum of live requested sizes
+    int peak_live_blocks;  // Largest number of live allocations
+} AllocationTrace;
+
+// Shapes of synthetic size distributions
+typedef enum SizeDistribution
+{
+    SIZE_UNIFORM,     // Uniform in [1, max]
+    SIZE_LOG_UNIFORM, // Uniform power-of-two range, then uniform within it
+    SIZE_BIMODAL      // Mostly 16..128 bytes, one in ten in [max/2, max]
+} SizeDistribution;
+
+const char *distribution_names[] = {"uniform", "log", "bimodal"};
+
+// Trace ids stay below the most blocks the pool could hold live at once
+#define TRACE_MAX_IDS (ARENA_SIZE / ARENA_ALIGN)
+
+// Function to append an operation to a trace
+int append_trace_op(AllocationTrace *trace, int id, int size)
+{
+    if (trace->count == trace->capacity)
+    {
+        long capacity = trace->capacity > 0 ? trace->capacity * 2 : 1024;
+        TraceOp *ops = realloc(trace->ops, sizeof(TraceOp) * capacity);
+        if (ops == NULL)
+        {
+            return 0;
+        }
+        trace->ops = ops;
+        trace->capacity = capacity;
+    }
+
+    trace->ops[trace->count].id = id;
+    trace->ops[trace->count].size = size;
+    trace->count++;
+    if (id >= trace->num_ids)
+    {
+        trace->num_ids = id + 1;
+    }
+    return 1;
+}
+
+// Function to free a trace
+void destroy_trace(AllocationTrace *trace)
+{
+    if (trace != NULL)
+    {
+        free(trace->ops);
+        free(trace);
+    }
+}
+
+// Function to find the peak live bytes and blocks of a trace; returns 0
+// if out of memory
+int measure_trace_peaks(AllocationTrace *trace)
+{
+    int *live_size = calloc(trace->num_ids > 0 ? trace->num_ids : 1, sizeof(int));
+    long live_bytes = 0;
+    int live_blocks = 0;
+
+    if (live_size == NULL)
+    {
+        return 0;
+    }
+    trace->allocations = 0;
+    trace->peak_live_bytes = 0;
+    trace->peak_live_blocks = 0;
+    for (long i = 0; i < trace->count; i++)
+    {
+        TraceOp op = trace->ops[i];
+        if (live_size[op.id] != 0)
+        {
+            live_bytes -= live_size[op.id];
+            live_size[op.id] = 0;
+            live_blocks--;
+        }
+        if (op.size > 0)
+        {
+            trace->allocations++;
+            live_size[op.id] = op.size;
+            live_bytes += op.size;
+            live_blocks++;
+        }
+
+        if (live_bytes > trace->peak_live_bytes)
+        {
+            trace->peak_live_bytes = live_bytes;
+        }
+        if (live_blocks > trace->peak_live_blocks)
+        {
+            trace->peak_live_blocks = live_blocks;
+        }
+    }
+    free(live_size);
+    return 1;
+}
+
+// Function to read a trace; returns NULL on error
+// Ids must be below TRACE_MAX_IDS, and an id must be freed before it is
+// allocated again.
+AllocationTrace *read_trace(FILE *in, const char *name)
+{
+    AllocationTrace *trace = calloc(1, sizeof(AllocationTrace));
+    unsigned char *live = NULL; // Whether each id is allocated
+    int live_capacity = 0;
+    char line[128];
+    long line_number = 0;
+    while (trace != NULL && fgets(line, sizeof(line), in) != NULL)
+    {
+        char kind = 0;
+        int id = -1, size = 0;
+        line_number++;
+        if (line[0] == '#' || line[0] == '\n')
+        {
+            continue;
+        }
+
+        int fields = sscanf(line, " %c %d %d", &kind, &id, &size);
+        int valid = id >= 0 && id < TRACE_MAX_IDS &&
+                    ((kind == 'a' && fields == 3 && size > 0) || (kind == 'f' && fields >= 2));
+        if (valid && id >= live_capacity)
+        {
+            int capacity = live_capacity > 0 ? live_capacity : 1024;
+            while (capacity <= id)
+            {
+                capacity *= 2;
+            }
+            unsigned char *grown = realloc(live, capacity);
+            if (grown == NULL)
+            {
+                printf("Error: Out of memory reading trace %s!\n", name);
+                destroy_trace(trace);
+                trace = NULL;
+                break;
+            }
+            memset(grown + live_capacity, 0, capacity - live_capacity);
+            live = grown;
+            live_capacity = capacity;
+        }
+        if (valid && kind == 'a' && live[id])
+        {
+            valid = 0;
+        }
+
+        if (!valid || !append_trace_op(trace, id, kind == 'a' ? size : 0))
+        {
+            printf("Error: Bad trace line %ld in %s!\n", line_number, name);
+            destroy_trace(trace);
+            trace = NULL;
+            break;
+        }
+        live[id] = kind == 'a';
+    }
+    free(live);
+
+    if (trace != NULL && !measure_trace_peaks(trace))
+    {
+        printf("Error: Out of memory reading trace %s!\n", name);
+        destroy_trace(trace);
+        trace = NULL;
+    }
+    return trace;
+}
+
+// Function to load a trace file; returns NULL on error
+AllocationTrace *load_trace(const char *path)
+{
+    FILE *in = fopen(path, "r");
+    if (in == NULL)
+    {
+        printf("Error: Could not open trace %s!\n", path);
+        return NULL;
+    }
+
+    AllocationTrace *trace = read_trace(in, path);
+    fclose(in);
+    return trace;
+}
+
+// Function to write a trace file
+int save_trace(const AllocationTrace *trace, const char *path)
+{
+    FILE *out = fopen(path, "w");
+    if (out == NULL)
+    {
+        return 0;
+    }
+
+    for (long i = 0; i < trace->count; i++)
+    {
+        if (trace->ops[i].size > 0)
+        {
+            fprintf(out, "a %d %d\n", trace->ops[i].id, trace->ops[i].size);
+        }
+        else
+        {
+            fprintf(out, "f %d\n", trace->ops[i].id);
+        }
+    }
+    return fclose(out) == 0;
+}
+
+// xorshift step for the trace generator
+unsigned int next_trace_random(unsigned int *seed)
+{
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return *seed;
+}
+
+// Function to draw one allocation size
+int draw_trace_size(SizeDistribution distribution, int max_size, unsigned int *seed)
+{
+    unsigned int r = next_trace_random(seed);
+
+    switch (distribution)
+    {
+    case SIZE_LOG_UNIFORM:
+    {
+        int top = 0;
+        while ((2 << top) <= max_size)
+        {
+            top++;
+        }
+        int low = 1 << (r % (top + 1));
+        int high = low * 2 - 1 < max_size ? low * 2 - 1 : max_size;
+        return low + (int)((r >> 8) % (high - low + 1));
+    }
+    case SIZE_BIMODAL:
+        if (r % 10 == 0 && max_size >= 2)
+        {
+            return max_size / 2 + (int)((r >> 8) % (max_size - max_size / 2 + 1));
+        }
+        return 16 + (int)((r >> 8) % 113);
+    case SIZE_UNIFORM:
+    default:
+        return 1 + (int)((r >> 8) % max_size);
+    }
+}
+
+// Function to generate a synthetic trace; returns NULL if out of memory
+// Every allocation lives for a uniformly drawn 1..2*mean_lifetime further
+// allocations; frees are ordered by expiry with a min-heap, and whatever is
+// live at the end is freed.
+AllocationTrace *generate_trace(long allocations, SizeDistribution distribution, int max_size,
+                                int mean_lifetime, unsigned int seed)
+{
+    AllocationTrace *trace = calloc(1, sizeof(AllocationTrace));
+    long *expiry = malloc(sizeof(long) * (allocations + 1)); // Heap keyed by expiry
+    int *heap_id = malloc(sizeof(int) * (allocations + 1));
+    int *free_ids = malloc(sizeof(int) * (allocations + 1)); // Ids ready for reuse
+    long heap_size = 0;
+    int num_free_ids = 0, next_id = 0;
+    int ok = 1;
+
+    if (trace == NULL || expiry == NULL || heap_id == NULL || free_ids == NULL)
+    {
+        free(expiry);
+        free(heap_id);
+        free(free_ids);
+        free(trace);
+        return NULL;
+    }
+
+    for (long now = 0; ok && now <= allocations; now++)
+    {
+        // Free everything that has expired, or everything at the end
+        while (ok && heap_size > 0 && (expiry[0] <= now || now == allocations))
+        {
+            int id = heap_id[0];
+            ok = append_trace_op(trace, id, 0);
+            free_ids[num_free_ids++] = id;
+
+            heap_size--;
+            long key = expiry[heap_size];
+            int key_id = heap_id[heap_size];
+            long i = 0;
+            for (;;)
+            {
+                long child = 2 * i + 1;
+                if (child >= heap_size)
+                {
+                    break;
+                }
+                if (child + 1 < heap_size && expiry[child + 1] < expiry[child])
+                {
+                    child++;
+                }
+                if (expiry[child] >= key)
+                {
+                    break;
+                }
+                expiry[i] = expiry[child];
+                heap_id[i] = heap_id[child];
+                i = child;
+            }
+            expiry[i] = key;
+            heap_id[i] = key_id;
+        }
+        if (!ok || now == allocations)
+        {
+            break;
+        }
+
+        int id = num_free_ids > 0 ? free_ids[--num_free_ids] : next_id++;
+        ok = append_trace_op(trace, id, draw_trace_size(distribution, max_size, &seed));
+
+        long i = heap_size++;
+        long key = now + 1 + next_trace_random(&seed) % (2 * (unsigned int)mean_lifetime);
+        while (i > 0 && expiry[(i - 1) / 2] > key)
+        {
+            expiry[i] = expiry[(i - 1) / 2];
+            heap_id[i] = heap_id[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        expiry[i] = key;
+        heap_id[i] = id;
+    }
+
+    free(expiry);
+    free(heap_id);
+    free(free_ids);
+    if (!ok || !measure_trace_peaks(trace))
+    {
+        destroy_trace(trace);
+        return NULL;
+    }
+    return trace;
+}
+
+// Results of replaying a trace through one allocator
+typedef struct TraceResult
+{
+    double ops_per_sec;
+    double p50_ns;         // Allocation latency percentiles
+    double p99_ns;
+    double p999_ns;
+    long peak_footprint;   // Highest pool byte handed out, -1 if unknown
+    long failures;         // Allocations that returned NULL
+    double fragmentation;  // Mean external fragmentation over samples, -1 if unknown
+    double search_steps;   // Lookup steps per allocation, -1 if unknown
+} TraceResult;
+
+int compare_floats(const void *a, const void *b)
+{
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+// Allocators the trace benchmark compares: the placement policies, then
+// the buddy pool, then the C library
+#define TRACE_BUDDY NUM_POLICIES
+#define TRACE_LIBC (NUM_POLICIES + 1)
+#define NUM_TRACE_TARGETS (NUM_POLICIES + 2)
+
+// Function to set up a fresh pool of at least pool_size bytes for a target
+int prepare_trace_target(int target, long pool_size)
+{
+    initialize_memory();
+    if (target < NUM_POLICIES)
+    {
+        set_placement_policy((PlacementPolicy)target);
+        add_memory_block((int)pool_size);
+        return total_regions == 1;
+    }
+    if (target == TRACE_BUDDY)
+    {
+        return initialize_buddy(buddy_order_for(pool_size));
+    }
+    return 1;
+}
+
+// Function to run one pass of a trace; with `latencies` set each
+// allocation is timed and the pool is sampled for fragmentation
+double replay_trace_pass(const AllocationTrace *trace, int target, void *live[],
+                         float *latencies, TraceResult *result)
+{
+    void *(*alloc_fn)(size_t) = target < NUM_POLICIES ? arena_malloc
+                                : target == TRACE_BUDDY ? buddy_malloc : malloc;
+    void (*free_fn)(void *) = target < NUM_POLICIES ? arena_free
+                              : target == TRACE_BUDDY ? buddy_free : free;
+    unsigned char *base = arena + (target == TRACE_BUDDY ? buddy_base : 0);
+    long timed = 0, samples = 0;
+    double fragmentation = 0.0;
+
+    result->failures = 0;
+    result->peak_footprint = target == TRACE_LIBC ? -1 : 0;
+
+    double start = now_ns();
+    for (long i = 0; i < trace->count; i++)
+    {
+        TraceOp op = trace->ops[i];
+        if (op.size == 0)
+        {
+            free_fn(live[op.id]);
+            live[op.id] = NULL;
+            continue;
+        }
+
+        if (latencies == NULL)
+        {
+            live[op.id] = alloc_fn(op.size);
+        }
+        else
+        {
+            double t0 = now_ns();
+            live[op.id] = alloc_fn(op.size);
+            latencies[timed++] = (float)(now_ns() - t0);
+        }
+
+        if (live[op.id] == NULL)
+        {
+            result->failures++;
+            continue;
+        }
+        if (target != TRACE_LIBC)
+        {
+            long end = (unsigned char *)live[op.id] - base + op.size;
+            if (end > result->peak_footprint)
+            {
+                result->peak_footprint = end;
+            }
+        }
+
+        // Sample fragmentation between operations, outside the timings
+        if (latencies != NULL && target != TRACE_LIBC && (timed & 1023) == 0)
+        {
+            PoolUsage usage = target == TRACE_BUDDY ? measure_buddy_usage() : measure_pool_usage();
+            fragmentation += external_fragmentation(usage);
+            samples++;
+        }
+    }
+    double elapsed = now_ns() - start;
+
+    // Free whatever the trace left live
+    for (int id = 0; id < trace->num_ids; id++)
+    {
+        free_fn(live[id]);
+        live[id] = NULL;
+    }
+
+    if (latencies != NULL)
+    {
+        result->fragmentation = samples > 0 ? fragmentation / samples : -1.0;
+        result->search_steps = target < NUM_POLICIES && trace->allocations > 0
+                                   ? (double)allocator_stats.search_steps / trace->allocations
+                                   : -1.0;
+    }
+    return elapsed;
+}
+
+// Function to replay a trace through one target: an untimed-per-op pass
+// for throughput, then a pass with per-allocation timings; returns 0 if
+// the target or the replay buffers cannot be set up
+int replay_trace(const AllocationTrace *trace, int target, long pool_size, TraceResult *result)
+{
+    void **live = calloc(trace->num_ids > 0 ? trace->num_ids : 1, sizeof(void *));
+    float *latencies = malloc(sizeof(float) * (trace->allocations > 0 ? trace->allocations : 1));
+
+    memset(result, 0, sizeof(TraceResult));
+    if (live == NULL || latencies == NULL || !prepare_trace_target(target, pool_size))
+    {
+        free(live);
+        free(latencies);
+        return 0;
+    }
+    double elapsed = replay_trace_pass(trace, target, live, NULL, result);
+    result->ops_per_sec = trace->count / (elapsed / 1e9);
+
+    if (!prepare_trace_target(target, pool_size))
+    {
+        free(live);
+        free(latencies);
+        return 0;
+    }
+    replay_trace_pass(trace, target, live, latencies, result);
+
+    long timed = trace->allocations;
+    if (timed > 0)
+    {
+        qsort(latencies, timed, sizeof(float), compare_floats);
+        result->p50_ns = latencies[timed / 2];
+        result->p99_ns = latencies[(long)(timed * 0.99)];
+        result->p999_ns = latencies[(long)(timed * 0.999)];
+    }
+
+    free(live);
+    free(latencies);
+    return 1;
+}
+
+// Function to parse a size distribution name
+int parse_distribution(const char *name, SizeDistribution *distribution)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        if (strcmp(name, distribution_names[i]) == 0)
+        {
+            *distribution = (SizeDistribution)i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Function to build a synthetic trace from command-line arguments:
+// [allocations] [uniform|log|bimodal] [max size] [mean lifetime]
+AllocationTrace *synthetic_trace_from_args(int argc, char *argv[])
+{
+    long allocations = argc > 0 ? atol(argv[0]) : 200000;
+    SizeDistribution distribution = SIZE_LOG_UNIFORM;
+    int max_size = argc > 2 ? atoi(argv[2]) : 4096;
+    int mean_lifetime = argc > 3 ? atoi(argv[3]) : 1000;
+
+    if (allocations <= 0 || (argc > 1 && !parse_distribution(argv[1], &distribution)) ||
+        max_size < 2 || mean_lifetime <= 0)
+    {
+        printf("Usage: [allocations] [uniform|log|bimodal] [max size] [mean lifetime]\n");
+        return NULL;
+    }
+
+    AllocationTrace *trace = generate_trace(allocations, distribution, max_size, mean_lifetime,
+                                            2463534242u);
+    if (trace == NULL)
+    {
+        printf("Error: Out of memory generating a trace of %ld allocations!\n", allocations);
+    }
+    return trace;
+}
+
+// Replay a trace file, or a synthetic trace, through every allocator
+int run_trace_benchmark(AllocationTrace *trace, const char *source)
+{
+    if (trace == NULL)
+    {
+        return 1;
+    }
+
+    // Pools get twice the peak live bytes, in 16-byte rounded allocations
+    long pool_size = 2 * (trace->peak_live_bytes + (long)trace->peak_live_blocks * ARENA_ALIGN);
+    if (pool_size > ARENA_SIZE / 2)
+    {
+        printf("Error: Trace peaks at %d live blocks and %ld bytes, too many for the pool!\n",
+               trace->peak_live_blocks, trace->peak_live_bytes);
+        destroy_trace(trace);
+        return 1;
+    }
+
+    printf("Trace %s: %ld operations, peak %d live blocks / %ld bytes, pool %ld bytes\n",
+           source, trace->count, trace->peak_live_blocks, trace->peak_live_bytes, pool_size);
+    printf("%-11s %12s %8s %8s %8s %10s %8s %9s %7s\n", "Allocator", "ops/sec", "p50 ns", "p99 ns",
+           "p99.9 ns", "footprint", "failed", "ext frag", "steps");
+    for (int target = 0; target < NUM_TRACE_TARGETS; target++)
+    {
+        const char *name = target < NUM_POLICIES ? policy_names[target]
+                           : target == TRACE_BUDDY ? "Buddy" : "libc malloc";
+        TraceResult r;
+        if (!replay_trace(trace, target, pool_size, &r))
+        {
+            printf("Error: Out of memory replaying the trace through %s!\n", name);
+            destroy_trace(trace);
+            return 1;
+        }
+
+        printf("%-11s %12.0f %8.0f %8.0f %8.0f ", name, r.ops_per_sec, r.p50_ns, r.p99_ns, r.p999_ns);
+        if (r.peak_footprint >= 0)
+        {
+            printf("%10ld ", r.peak_footprint);
+        }
+        else
+        {
+            printf("%10s ", "-");
+        }
+        printf("%7.2f%% ", trace->allocations > 0 ? 100.0 * r.failures / trace->allocations : 0.0);
+        if (r.fragmentation >= 0)
+        {
+            printf("%8.1f%% ", r.fragmentation);
+        }
+        else
+        {
+            printf("%9s ", "-");
+        }
+        if (r.search_steps >= 0)
+        {
+            printf("%7.1f\n", r.search_steps);
+        }
+        else
+        {
+            printf("%7s\n", "-");
+        }
+    }
+
+    destroy_trace(trace);
+    return 0;
+}
+
+// Traces the loader must accept or reject, with the allocations counted
+typedef struct TraceCheck
+{
+    const char *text;
+    int accepted;
+    long allocations;
+} TraceCheck;
+
+// Function to check the trace loader on hand-written traces, and replay
+// the accepted ones through every allocator
+int run_trace_check()
+{
+    TraceCheck checks[] = {
+        {"a 1 10\na 1 20\nf 1\n", 0, 0},               // Id 1 allocated while live
+        {"a 1 10\nf 1\na 1 20\nf 1\n", 1, 2},          // Id 1 reused after its free
+        {"a 0 16\na 1 32\nf 0\na 0 8\n", 1, 3},        // Left live at the end
+        {"a 2000000000 8\n", 0, 0},                   // Id past TRACE_MAX_IDS
+        {"# comment\n\na 0 8\nf 0\nf 0\n", 1, 1},     // Double free of an id
+    };
+    int num_checks = sizeof(checks) / sizeof(checks[0]);
+    int mismatches = 0;
+
+    for (int i = 0; i < num_checks; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "check %d", i + 1);
+        FILE *in = fmemopen((void *)checks[i].text, strlen(checks[i].text), "r");
+        if (in == NULL)
+        {
+            printf("Error: Could not open %s!\n", name);
+            return 1;
+        }
+        AllocationTrace *trace = read_trace(in, name);
+        fclose(in);
+
+        int ok = (trace != NULL) == checks[i].accepted;
+        if (ok && trace != NULL)
+        {
+            ok = trace->allocations == checks[i].allocations;
+            for (int target = 0; ok && target < NUM_TRACE_TARGETS; target++)
+            {
+                TraceResult r;
+                ok = replay_trace(trace, target, 4096, &r) && r.failures == 0;
+            }
+        }
+        if (!ok)
+        {
+            printf("Mismatch in %s: expected the trace to be %s\n", name,
+                   checks[i].accepted ? "accepted" : "rejected");
+            mismatches++;
+        }
+        destroy_trace(trace);
+    }
+
+    printf("Checked %d traces: %d mismatches\n", num_checks, mismatches);
+    return mismatches > 0 ? 1 : 0;
+}
+
+// Function to demonstrate the buddy allocator on a 1024-byte pool
+int run_buddy_demo()
+{
+    initialize_memory();
+    if (!initialize_buddy(10))
+    {
+        printf("Error: Could not set up the buddy pool!\n");
+        return 1;
+    }
+    display_buddy_status();
+
+    // Allocate memory using the buddy system
+    void *block1 = buddy_malloc(250);
+    void *block2 = buddy_malloc(150);
+    void *block3 = buddy_malloc(400);
+    printf("Buddy allocated: 250 -> offset %ld, 150 -> offset %ld, 400 -> offset %ld\n",
+           (long)((unsigned char *)block1 - arena - buddy_base),
+           (long)((unsigned char *)block2 - arena - buddy_base),
+           (long)((unsigned char *)block3 - arena - buddy_base));
+    display_buddy_status();
+
+    // Free some allocated memory; buddies merge back
+    buddy_free(block1);
+    buddy_free(block2);
+    display_buddy_status();
+
+    return 0;
+}
+
+// Worker of the multithreaded stress benchmark
+typedef struct StressWorker
+{
+    void *(*alloc_fn)(size_t);
+    void (*free_fn)(void *);
+    long operations;
+    int num_live;
+    unsigned int seed;
+    long failures;
+} StressWorker;
+
+void *stress_worker(void *arg)
+{
+    StressWorker *w = arg;
+    void **live = calloc(w->num_live, sizeof(void *));
+
+    for (long op = 0; op < w->operations; op++)
+    {
+        w->seed ^= w->seed << 13;
+        w->seed ^= w->seed >> 17;
+        w->seed ^= w->seed << 5;
+
+        // Mostly small blocks, one in eight up to 2 KiB
+        int slot = w->seed % w->num_live;
+        size_t size = (w->seed >> 8) % 8 == 0 ? 1 + (w->seed >> 12) % 2048
+                                                : 1 + (w->seed >> 12) % TCACHE_MAX_SIZE;
+        w->free_fn(live[slot]);
+        live[slot] = w->alloc_fn(size);
+        if (live[slot] == NULL)
+        {
+            w->failures++;
+            continue;
+        }
+        *(volatile unsigned char *)live[slot] = (unsigned char)op; // Touch the block
+    }
+
+    for (int k = 0; k < w->num_live; k++)
+    {
+        w->free_fn(live[k]);
+    }
+    free(live);
+    return NULL;
+}
+
+// Multithreaded alloc/free stress: the locked pool alone, the pool behind
+// thread caches, and the C library
+int run_thread_benchmark(int argc, char *argv[])
+{
+    int threads = argc > 0 ? atoi(argv[0]) : 4;
+    long operations = argc > 1 ? atol(argv[1]) : 1000000;
+    int num_live = argc > 2 ? atoi(argv[2]) : 64;
+
+    if (threads <= 0 || operations <= 0 || num_live <= 0)
+    {
+        printf("Usage: memory_allocation --bench-threads [threads] [operations] [live blocks]\n");
+        return 1;
+    }
+
+    const char *names[] = {"Locked pool", "Thread cache", "libc malloc"};
+    void *(*alloc_fns[])(size_t) = {pool_malloc, tcache_malloc, malloc};
+    void (*free_fns[])(void *) = {pool_free, tcache_free, free};
+    pthread_t *ids = malloc(sizeof(pthread_t) * threads);
+    StressWorker *workers = calloc(threads, sizeof(StressWorker));
+
+    printf("%d threads x %ld operations, %d live blocks each\n", threads, operations, num_live);
+    for (int mode = 0; mode < 3; mode++)
+    {
+        initialize_memory();
+        set_placement_policy(BEST_FIT);
+        add_memory_block(ARENA_SIZE / 2);
+
+        for (int i = 0; i < threads; i++)
+        {
+            workers[i].alloc_fn = alloc_fns[mode];
+            workers[i].free_fn = free_fns[mode];
+            workers[i].operations = operations;
+            workers[i].num_live = num_live;
+            workers[i].seed = 2463534242u + 7919u * i;
+            workers[i].failures = 0;
+        }
+
+        double start = now_ns();
+        for (int i = 0; i < threads; i++)
+        {
+            pthread_create(&ids[i], NULL, stress_worker, &workers[i]);
+        }
+        long failures = 0;
+        for (int i = 0; i < threads; i++)
+        {
+            pthread_join(ids[i], NULL);
+            failures += workers[i].failures;
+        }
+        double seconds = (now_ns() - start) / 1e9;
+
+        printf("%-12s: %12.0f ops/sec, %ld failed\n", names[mode],
+               threads * operations / seconds, failures);
+    }
+
+    free(ids);
+    free(workers);
+    return 0;
+}
+
+// Main function to demonstrate memory allocation
+int main(int argc, char *argv[])
+{
+    // Benchmark mode
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        return run_allocator_benchmark(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-threads") == 0)
+    {
+        return run_thread_benchmark(argc - 2, argv + 2);
+    }
+    if (argc > 2 && strcmp(argv[1], "--trace") == 0)
+    {
+        return run_trace_benchmark(load_trace(argv[2]), argv[2]);
+    }
+    if (argc > 1 && strcmp(argv[1], "--trace-synthetic") == 0)
+    {
+        return run_trace_benchmark(synthetic_trace_from_args(argc - 2, argv + 2), "synthetic");
+    }
+    if (argc > 1 && strcmp(argv[1], "--trace-check") == 0)
+    {
+        return run_trace_check();
+    }
+    if (argc > 2 && strcmp(argv[1], "--trace-gen") == 0)
+    {
+        AllocationTrace *trace = synthetic_trace_from_args(argc - 3, argv + 3);
+        int saved = trace != NULL && save_trace(trace, argv[2]);
+        if (trace != NULL && !saved)
+        {
+            printf("Error: Could not write trace %s!\n", argv[2]);
+        }
+        destroy_trace(trace);
+        return saved ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "buddy") == 0)
+    {
+        return run_buddy_demo();
+    }
+
+    // Placement policy from the command line, best fit by default
+    PlacementPolicy policy = BEST_FIT;
+    if (argc > 1 && !parse_placement_policy(argv[1], &policy))
+    {
+        printf("Usage: memory_allocation [first|next|best|worst|buddy] | --bench ...\n");
+        return 1;
+    }
+    set_placement_policy(policy);
+    printf("Placement policy: %s\n", policy_names[placement_policy]);
+
+    // Initialize memory
+    initialize_memory();
+
+    // Add memory blocks to the pool
+    add_memory_block(100);
+    add_memory_block(500);
+    add_memory_block(200);
+    add_memory_block(300);
+    add_memory_block(600);
+
+    // Display initial memory status
+    display_memory_status();
+
+    // Allocate memory using the placement policy
+    int block1 = allocate_memory(250);
+    int block2 = allocate_memory(150);
+    int block3 = allocate_memory(400);
+
+    // Display memory status after allocation
+    display_memory_status();
+
+    // Free some allocated memory
+    free_memory(block1);
+    free_memory(block2);
+
+    // Display final memory status
+    display_memory_status();
+    dump_allocator_stats(stdout);
+
+    return 0;
+}
\ No newline at end of file
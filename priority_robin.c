@@ -1,8 +1,18 @@
+#define _DEFAULT_SOURCE // For process_trace.h under -std=c11
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <string.h>
+#include <time.h>
+
+#include "process_sort.h"
+#include "process_trace.h"
 
 #define MAX_PROCESSES 100
+#define MLFQ_MAX_LEVELS 32 // One bit per level in the non-empty bitmap
+#define DEFAULT_AGING_INTERVAL 5 // Waiting time that earns one priority level
+#define PRIORITY_KEY_UNIT 4294967296LL // One priority level in a ready key
 
 // Process structure
 typedef struct Process
@@ -12,35 +22,57 @@ typedef struct Process
     int burst_time;      // Total CPU burst time
     int remaining_time;  // Remaining burst time
     int priority;        // Priority value (lower number = higher priority)
+    int effective_priority; // Priority after aging
+    int aging_left;      // Wait still needed for the next aging step
     int waiting_time;    // Waiting time
     int turnaround_time; // Turnaround time
 } Process;
 
+// Multilevel feedback queue settings
+typedef struct MlfqConfig
+{
+    int levels;                        // Level 0 is the highest priority
+    int time_quantum[MLFQ_MAX_LEVELS]; // Slice length at each level
+    int boost_interval;                // Time between priority boosts, 0 for none
+} MlfqConfig;
+
+// One FIFO per level, linked through next[], and a bitmap of the levels
+// that hold processes, so the highest ready level is found in O(1)
+typedef struct MlfqQueues
+{
+    int head[MLFQ_MAX_LEVELS];
+    int tail[MLFQ_MAX_LEVELS];
+    int *next;             // Successor of each process in its level
+    unsigned int nonempty; // Bit k is set while level k holds processes
+} MlfqQueues;
+
+// Binary min-heap of process indices with a position map, so the key of
+// any queued process can be changed, or the process removed, in O(log n)
+typedef struct IndexedHeap
+{
+    int *items;     // Process indices in heap order
+    int *position;  // Heap position of each process, -1 when not queued
+    long long *key; // Key of each process; ties go to the lower index
+    int size;
+} IndexedHeap;
+
 // Function prototypes
 void priority_scheduling(Process processes[], int n);
 void round_robin_scheduling(Process processes[], int n, int time_quantum);
+void mlfq_scheduling(Process processes[], int n, const MlfqConfig *config);
+void preemptive_priority_scheduling(Process processes[], int n, int aging_interval);
 void display_process_details(Process processes[], int n);
+void sort_by_priority(Process processes[], int n);
+int run_trace_simulation(int argc, char *argv[]);
+int run_trace_check();
 
 // Priority Scheduling Algorithm
 void priority_scheduling(Process processes[], int n)
 {
-    Process temp;
     int total_waiting_time = 0, total_turnaround_time = 0;
 
     // Sort processes based on priority (lower number = higher priority)
-    for (int i = 0; i < n - 1; i++)
-    {
-        for (int j = 0; j < n - i - 1; j++)
-        {
-            if (processes[j].priority > processes[j + 1].priority)
-            {
-                // Swap processes
-                temp = processes[j];
-                processes[j] = processes[j + 1];
-                processes[j + 1] = temp;
-            }
-        }
-    }
+    sort_by_priority(processes, n);
 
     // Calculate waiting and turnaround times
     processes[0].waiting_time = 0;
@@ -70,69 +102,717 @@ void priority_scheduling(Process processes[], int n)
            (float)total_turnaround_time / n);
 }
 
+// Sort processes by priority, keeping input order among equals
+void sort_by_priority(Process processes[], int n)
+{
+    if (n < 2)
+    {
+        return;
+    }
+
+    int *keys = malloc(sizeof(int) * n);
+    if (keys == NULL)
+    {
+        printf("Error: Memory allocation failed!\n");
+        return;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        keys[i] = processes[i].priority;
+    }
+
+    if (!sort_records_by_key(processes, sizeof(Process), keys, n))
+    {
+        printf("Error: Memory allocation failed!\n");
+    }
+    free(keys);
+}
+
 // Round Robin Scheduling Algorithm
+// Processes join a circular FIFO when they arrive, taken in arrival order
+// from a sorted index array; a preempted process rejoins behind the
+// processes that arrived during its quantum. Each quantum is O(1) and
+// finished processes never come back into the queue.
 void round_robin_scheduling(Process processes[], int n, int time_quantum)
 {
-    int total_waiting_time = 0, total_turnaround_time = 0;
-    int current_time = 0;
-    int completed_processes = 0;
+    long long total_waiting_time = 0, total_turnaround_time = 0;
+
+    if (n <= 0)
+    {
+        return;
+    }
+    if (time_quantum <= 0)
+    {
+        printf("Error: Time quantum must be positive!\n");
+        return;
+    }
+
+    int *arrival_order = malloc(sizeof(int) * n);
+    int *keys = malloc(sizeof(int) * n);
+    int *ready_queue = malloc(sizeof(int) * n); // Never holds more than n
+    if (arrival_order == NULL || keys == NULL || ready_queue == NULL)
+    {
+        printf("Error: Memory allocation failed!\n");
+        free(arrival_order);
+        free(keys);
+        free(ready_queue);
+        return;
+    }
 
-    // Create a copy of processes to manipulate
-    Process queue[MAX_PROCESSES];
     for (int i = 0; i < n; i++)
     {
-        queue[i] = processes[i];
-        queue[i].remaining_time = queue[i].burst_time;
+        processes[i].remaining_time = processes[i].burst_time;
+        keys[i] = processes[i].arrival_time;
+    }
+    int sorted = sort_indices_by_key(keys, arrival_order, n);
+    free(keys);
+    if (!sorted)
+    {
+        printf("Error: Memory allocation failed!\n");
+        free(arrival_order);
+        free(ready_queue);
+        return;
     }
 
+    int current_time = 0;
+    int next_arrival = 0; // Position in arrival_order of the next arrival
+    int queue_head = 0, queue_count = 0;
+    int preempted = -1; // Process waiting to rejoin the queue
+    int completed_processes = 0;
+
     // Round Robin scheduling simulation
     while (completed_processes < n)
     {
-        for (int i = 0; i < n; i++)
+        // If no process is available, skip ahead to the next arrival
+        if (queue_count == 0 && preempted == -1 &&
+            current_time < processes[arrival_order[next_arrival]].arrival_time)
+        {
+            current_time = processes[arrival_order[next_arrival]].arrival_time;
+        }
+
+        // Queue every process that has arrived by now, then the preempted one
+        while (next_arrival < n && processes[arrival_order[next_arrival]].arrival_time <= current_time)
+        {
+            int tail = queue_head + queue_count++;
+            ready_queue[tail < n ? tail : tail - n] = arrival_order[next_arrival++];
+        }
+        if (preempted != -1)
         {
-            // Skip already completed processes
-            if (queue[i].remaining_time <= 0)
-                continue;
+            int tail = queue_head + queue_count++;
+            ready_queue[tail < n ? tail : tail - n] = preempted;
+            preempted = -1;
+        }
 
-            // Process for time quantum or remaining time
-            if (queue[i].remaining_time > time_quantum)
-            {
-                current_time += time_quantum;
-                queue[i].remaining_time -= time_quantum;
-            }
-            else
-            {
-                current_time += queue[i].remaining_time;
-                queue[i].remaining_time = 0;
+        int i = ready_queue[queue_head];
+        queue_head = queue_head + 1 < n ? queue_head + 1 : 0;
+        queue_count--;
 
-                // Calculate waiting and turnaround times
-                queue[i].turnaround_time = current_time;
-                queue[i].waiting_time =
-                    queue[i].turnaround_time - queue[i].burst_time;
+        // Process for time quantum or remaining time
+        if (processes[i].remaining_time > time_quantum)
+        {
+            current_time += time_quantum;
+            processes[i].remaining_time -= time_quantum;
+            preempted = i;
+            continue;
+        }
 
-                total_waiting_time += queue[i].waiting_time;
-                total_turnaround_time += queue[i].turnaround_time;
+        current_time += processes[i].remaining_time;
+        processes[i].remaining_time = 0;
 
-                completed_processes++;
-            }
+        // Calculate waiting and turnaround times
+        processes[i].turnaround_time = current_time - processes[i].arrival_time;
+        processes[i].waiting_time =
+            processes[i].turnaround_time - processes[i].burst_time;
+
+        total_waiting_time += processes[i].waiting_time;
+        total_turnaround_time += processes[i].turnaround_time;
+
+        completed_processes++;
+    }
+    free(arrival_order);
+    free(ready_queue);
+
+    // Print results
+    printf("\n--- Round Robin Scheduling Results ---\n");
+    printf("Time Quantum: %d\n", time_quantum);
+    display_process_details(processes, n);
+
+    printf("\nAverage Waiting Time: %.2f\n",
+           (double)total_waiting_time / n);
+    printf("Average Turnaround Time: %.2f\n",
+           (double)total_turnaround_time / n);
+}
+
+// Function to build an MLFQ configuration whose quantum doubles at each
+// level; returns 0 for invalid settings
+int make_mlfq_config(MlfqConfig *config, int levels, int base_quantum, int boost_interval)
+{
+    if (levels < 1 || levels > MLFQ_MAX_LEVELS || base_quantum <= 0 || boost_interval < 0)
+    {
+        return 0;
+    }
+
+    config->levels = levels;
+    config->boost_interval = boost_interval;
+    long long quantum = base_quantum;
+    for (int level = 0; level < levels; level++)
+    {
+        config->time_quantum[level] = (int)quantum;
+        quantum = quantum * 2 > INT_MAX ? INT_MAX : quantum * 2;
+    }
+    return 1;
+}
+
+// Function to build an MLFQ configuration from a quantum argument: one
+// base quantum that doubles at each level, or a comma-separated list with
+// a quantum for every level such as "2,4,16"; returns 0 for invalid settings
+int parse_mlfq_config(MlfqConfig *config, int levels, const char *quanta, int boost_interval)
+{
+    if (strchr(quanta, ',') == NULL)
+    {
+        return make_mlfq_config(config, levels, atoi(quanta), boost_interval);
+    }
+    if (!make_mlfq_config(config, levels, 1, boost_interval))
+    {
+        return 0;
+    }
+
+    const char *field = quanta;
+    for (int level = 0; level < levels; level++)
+    {
+        char *end;
+        long quantum = strtol(field, &end, 10);
+        char separator = level + 1 < levels ? ',' : '\0';
+        if (end == field || quantum <= 0 || quantum > INT_MAX || *end != separator)
+        {
+            return 0;
+        }
+        config->time_quantum[level] = (int)quantum;
+        field = end + 1;
+    }
+    return 1;
+}
+
+// Function to append a process to the FIFO of a level
+void mlfq_push(MlfqQueues *queues, int level, int process)
+{
+    queues->next[process] = -1;
+    if (queues->nonempty & (1u << level))
+    {
+        queues->next[queues->tail[level]] = process;
+    }
+    else
+    {
+        queues->head[level] = process;
+        queues->nonempty |= 1u << level;
+    }
+    queues->tail[level] = process;
+}
+
+// Function to remove the first process of the highest non-empty level
+int mlfq_pop(MlfqQueues *queues, int *level)
+{
+    int top = __builtin_ctz(queues->nonempty);
+    int process = queues->head[top];
+
+    queues->head[top] = queues->next[process];
+    if (queues->head[top] == -1)
+    {
+        queues->nonempty &= ~(1u << top);
+    }
+    *level = top;
+    return process;
+}
+
+// Function to boost every queued process to level 0
+// Whole level lists are spliced onto level 0 in level order, so a boost
+// costs O(levels) however many processes are waiting.
+void mlfq_boost(MlfqQueues *queues)
+{
+    unsigned int lower = queues->nonempty & ~1u;
+    while (lower != 0)
+    {
+        int level = __builtin_ctz(lower);
+        lower &= lower - 1;
+
+        if (queues->nonempty & 1u)
+        {
+            queues->next[queues->tail[0]] = queues->head[level];
         }
+        else
+        {
+            queues->head[0] = queues->head[level];
+        }
+        queues->tail[0] = queues->tail[level];
+        queues->nonempty |= 1u;
+    }
+    queues->nonempty &= 1u;
+}
+
+// Function to print the per-level dispatch counts of an MLFQ run
+void display_mlfq_levels(const MlfqConfig *config, const long long level_dispatches[], long long boosts)
+{
+    printf("Level\tQuantum\tDispatches\n");
+    for (int level = 0; level < config->levels; level++)
+    {
+        printf("%d\t%d\t%lld\n", level, config->time_quantum[level], level_dispatches[level]);
+    }
+    printf("Boost Interval: %d (%lld boosts)\n", config->boost_interval, boosts);
+}
+
+// Multilevel Feedback Queue Scheduling
+// Arriving processes enter level 0. A process that uses its whole slice
+// drops one level and rejoins behind the arrivals of that slice; slices are
+// not cut short by arrivals. Every boost_interval time units all waiting
+// processes, the preempted one included, return to level 0 so long jobs
+// cannot starve.
+void mlfq_scheduling(Process processes[], int n, const MlfqConfig *config)
+{
+    long long total_waiting_time = 0, total_turnaround_time = 0;
+    long long level_dispatches[MLFQ_MAX_LEVELS] = {0};
+    long long boosts = 0;
+
+    if (n <= 0)
+    {
+        return;
+    }
+
+    MlfqQueues queues;
+    int *arrival_order = malloc(sizeof(int) * n);
+    int *keys = malloc(sizeof(int) * n);
+    queues.next = malloc(sizeof(int) * n);
+    queues.nonempty = 0;
+    if (arrival_order == NULL || keys == NULL || queues.next == NULL)
+    {
+        printf("Error: Memory allocation failed!\n");
+        free(arrival_order);
+        free(keys);
+        free(queues.next);
+        return;
     }
 
-    // Replace original processes with modified queue
     for (int i = 0; i < n; i++)
     {
-        processes[i] = queue[i];
+        processes[i].remaining_time = processes[i].burst_time;
+        keys[i] = processes[i].arrival_time;
+    }
+    int sorted = sort_indices_by_key(keys, arrival_order, n);
+    free(keys);
+    if (!sorted)
+    {
+        printf("Error: Memory allocation failed!\n");
+        free(arrival_order);
+        free(queues.next);
+        return;
+    }
+
+    int current_time = 0;
+    long long next_boost = config->boost_interval;
+    int next_arrival = 0;   // Position in arrival_order of the next arrival
+    int preempted = -1;     // Process waiting to rejoin a queue
+    int preempted_level = 0;
+    int completed_processes = 0;
+
+    while (completed_processes < n)
+    {
+        // If no process is available, skip ahead to the next arrival
+        if (queues.nonempty == 0 && preempted == -1 &&
+            current_time < processes[arrival_order[next_arrival]].arrival_time)
+        {
+            current_time = processes[arrival_order[next_arrival]].arrival_time;
+        }
+
+        while (next_arrival < n && processes[arrival_order[next_arrival]].arrival_time <= current_time)
+        {
+            mlfq_push(&queues, 0, arrival_order[next_arrival++]);
+        }
+
+        int boost = config->boost_interval > 0 && current_time >= next_boost;
+        if (boost)
+        {
+            mlfq_boost(&queues);
+            boosts++;
+            next_boost = ((long long)current_time / config->boost_interval + 1) * config->boost_interval;
+        }
+
+        // Demote the process that used up its slice, unless just boosted
+        if (preempted != -1)
+        {
+            int level = preempted_level + 1 < config->levels ? preempted_level + 1 : preempted_level;
+            mlfq_push(&queues, boost ? 0 : level, preempted);
+            preempted = -1;
+        }
+
+        int level;
+        int i = mlfq_pop(&queues, &level);
+        level_dispatches[level]++;
+
+        if (processes[i].remaining_time > config->time_quantum[level])
+        {
+            current_time += config->time_quantum[level];
+            processes[i].remaining_time -= config->time_quantum[level];
+            preempted = i;
+            preempted_level = level;
+            continue;
+        }
+
+        current_time += processes[i].remaining_time;
+        processes[i].remaining_time = 0;
+
+        // Calculate waiting and turnaround times
+        processes[i].turnaround_time = current_time - processes[i].arrival_time;
+        processes[i].waiting_time =
+            processes[i].turnaround_time - processes[i].burst_time;
+
+        total_waiting_time += processes[i].waiting_time;
+        total_turnaround_time += processes[i].turnaround_time;
+
+        completed_processes++;
     }
+    free(arrival_order);
+    free(queues.next);
 
     // Print results
-    printf("\n--- Round Robin Scheduling Results ---\n");
-    printf("Time Quantum: %d\n", time_quantum);
+    printf("\n--- Multilevel Feedback Queue Scheduling Results ---\n");
     display_process_details(processes, n);
 
+    printf("\n");
+    display_mlfq_levels(config, level_dispatches, boosts);
+
     printf("\nAverage Waiting Time: %.2f\n",
-           (float)total_waiting_time / n);
+           (double)total_waiting_time / n);
     printf("Average Turnaround Time: %.2f\n",
-           (float)total_turnaround_time / n);
+           (double)total_turnaround_time / n);
+}
+
+// Function to allocate an indexed heap for processes 0..capacity-1
+int init_indexed_heap(IndexedHeap *heap, int capacity)
+{
+    heap->items = malloc(sizeof(int) * capacity);
+    heap->position = malloc(sizeof(int) * capacity);
+    heap->key = malloc(sizeof(long long) * capacity);
+    heap->size = 0;
+    if (heap->items == NULL || heap->position == NULL || heap->key == NULL)
+    {
+        return 0;
+    }
+
+    memset(heap->position, 0xff, sizeof(int) * capacity); // Every entry -1
+    return 1;
+}
+
+// Function to make room for processes old_capacity..capacity-1
+int grow_indexed_heap(IndexedHeap *heap, int old_capacity, int capacity)
+{
+    int *items = realloc(heap->items, sizeof(int) * capacity);
+    if (items != NULL)
+    {
+        heap->items = items;
+    }
+    int *position = realloc(heap->position, sizeof(int) * capacity);
+    if (position != NULL)
+    {
+        heap->position = position;
+        memset(position + old_capacity, 0xff, sizeof(int) * (capacity - old_capacity));
+    }
+    long long *key = realloc(heap->key, sizeof(long long) * capacity);
+    if (key != NULL)
+    {
+        heap->key = key;
+    }
+    return items != NULL && position != NULL && key != NULL;
+}
+
+// Function to release an indexed heap
+void free_indexed_heap(IndexedHeap *heap)
+{
+    free(heap->items);
+    free(heap->position);
+    free(heap->key);
+}
+
+// Function to order two heap entries: smaller key first, then lower index
+int heap_before(const IndexedHeap *heap, int a, int b)
+{
+    if (heap->key[a] != heap->key[b])
+    {
+        return heap->key[a] < heap->key[b];
+    }
+    return a < b;
+}
+
+// Function to move the entry at pos up or down to its place
+void heap_restore(IndexedHeap *heap, int pos)
+{
+    int item = heap->items[pos];
+
+    while (pos > 0 && heap_before(heap, item, heap->items[(pos - 1) / 2]))
+    {
+        heap->items[pos] = heap->items[(pos - 1) / 2];
+        heap->position[heap->items[pos]] = pos;
+        pos = (pos - 1) / 2;
+    }
+
+    for (;;)
+    {
+        int child = 2 * pos + 1;
+        if (child >= heap->size)
+        {
+            break;
+        }
+        if (child + 1 < heap->size && heap_before(heap, heap->items[child + 1], heap->items[child]))
+        {
+            child++;
+        }
+        if (!heap_before(heap, heap->items[child], item))
+        {
+            break;
+        }
+        heap->items[pos] = heap->items[child];
+        heap->position[heap->items[pos]] = pos;
+        pos = child;
+    }
+
+    heap->items[pos] = item;
+    heap->position[item] = pos;
+}
+
+// Function to insert a process or change its key
+void heap_set_key(IndexedHeap *heap, int index, long long key)
+{
+    heap->key[index] = key;
+    if (heap->position[index] == -1)
+    {
+        heap->items[heap->size] = index;
+        heap->position[index] = heap->size++;
+    }
+    heap_restore(heap, heap->position[index]);
+}
+
+// Function to take a process out of the heap, if it is queued
+void heap_remove(IndexedHeap *heap, int index)
+{
+    int pos = heap->position[index];
+    if (pos == -1)
+    {
+        return;
+    }
+
+    heap->position[index] = -1;
+    int last = heap->items[--heap->size];
+    if (pos < heap->size)
+    {
+        heap->items[pos] = last;
+        heap_restore(heap, pos);
+    }
+}
+
+// Function to queue a newly arrived process at its base priority; it ages
+// once every aging_interval time units it keeps waiting
+// The ready key is the effective priority in the high half, with the tie
+// (earlier arrival first) in the low 32 bits, so aging one level is a
+// decrease-key by PRIORITY_KEY_UNIT.
+void queue_waiting_process(Process processes[], IndexedHeap *ready, IndexedHeap *aging, int index,
+                           int tie, long long current_time, int aging_interval, int priority_floor)
+{
+    Process *process = &processes[index];
+
+    process->effective_priority = process->priority;
+    heap_set_key(ready, index, process->priority * PRIORITY_KEY_UNIT + tie);
+    if (aging_interval > 0 && process->priority > priority_floor)
+    {
+        heap_set_key(aging, index, current_time + aging_interval);
+    }
+}
+
+// Function to take a waiting process off the queues to run it, saving the
+// wait it still needs for its next aging step (0 once it stops aging)
+void dispatch_waiting_process(Process processes[], IndexedHeap *ready, IndexedHeap *aging,
+                              int index, long long current_time)
+{
+    processes[index].aging_left =
+        aging->position[index] != -1 ? (int)(aging->key[index] - current_time) : 0;
+    heap_remove(ready, index);
+    heap_remove(aging, index);
+}
+
+// Function to put a preempted process back in the ready queue
+// It keeps the effective priority it aged to and resumes its aging
+// interval where it left off, so repeated preemption cannot send a
+// process back to its base priority.
+void requeue_preempted_process(Process processes[], IndexedHeap *ready, IndexedHeap *aging,
+                               int index, int tie, long long current_time)
+{
+    Process *process = &processes[index];
+
+    heap_set_key(ready, index, process->effective_priority * PRIORITY_KEY_UNIT + tie);
+    if (process->aging_left > 0)
+    {
+        heap_set_key(aging, index, current_time + process->aging_left);
+    }
+}
+
+// Function to apply every aging step due by current_time
+// A process stops aging once it reaches priority_floor, the best base
+// priority of the workload, which bounds both its wait and the number of
+// steps. Returns the number of steps taken.
+long long age_waiting_processes(Process processes[], IndexedHeap *ready, IndexedHeap *aging,
+                                long long current_time, int aging_interval, int priority_floor)
+{
+    long long steps = 0;
+
+    while (aging->size > 0 && aging->key[aging->items[0]] <= current_time)
+    {
+        int index = aging->items[0];
+        Process *process = &processes[index];
+
+        process->effective_priority--;
+        heap_set_key(ready, index, ready->key[index] - PRIORITY_KEY_UNIT);
+        if (process->effective_priority > priority_floor)
+        {
+            heap_set_key(aging, index, aging->key[index] + aging_interval);
+        }
+        else
+        {
+            heap_remove(aging, index);
+        }
+        steps++;
+    }
+    return steps;
+}
+
+// Preemptive Priority Scheduling with Aging
+// Event driven over arrivals, aging steps and completions. The running
+// process is preempted only by a waiting process with a strictly better
+// effective priority. Only waiting processes age; a process keeps the
+// priority it aged to while it runs and when it is preempted, so once it
+// reaches the floor it can no longer be preempted.
+void preemptive_priority_scheduling(Process processes[], int n, int aging_interval)
+{
+    long long total_waiting_time = 0, total_turnaround_time = 0;
+    long long aging_steps = 0;
+    int preemptions = 0;
+
+    if (n <= 0)
+    {
+        return;
+    }
+
+    IndexedHeap ready, aging;
+    int *arrival_order = malloc(sizeof(int) * n);
+    int *rank = malloc(sizeof(int) * n); // Position of each process in arrival order
+    int ok = arrival_order != NULL && rank != NULL;
+    ok = init_indexed_heap(&ready, n) && ok;
+    ok = init_indexed_heap(&aging, n) && ok;
+
+    int priority_floor = INT_MAX;
+    for (int i = 0; ok && i < n; i++)
+    {
+        processes[i].remaining_time = processes[i].burst_time;
+        rank[i] = processes[i].arrival_time; // Sort key until ranked below
+        if (processes[i].priority < priority_floor)
+        {
+            priority_floor = processes[i].priority;
+        }
+    }
+    ok = ok && sort_indices_by_key(rank, arrival_order, n);
+    if (!ok)
+    {
+        printf("Error: Memory allocation failed!\n");
+        free(arrival_order);
+        free(rank);
+        free_indexed_heap(&ready);
+        free_indexed_heap(&aging);
+        return;
+    }
+    for (int r = 0; r < n; r++)
+    {
+        rank[arrival_order[r]] = r;
+    }
+
+    long long current_time = 0;
+    int next_arrival = 0; // Position in arrival_order of the next arrival
+    int running = -1;     // Process on the CPU, -1 when idle
+    int completed_processes = 0;
+
+    while (completed_processes < n)
+    {
+        // If no process is available, skip ahead to the next arrival
+        if (running == -1 && ready.size == 0 &&
+            current_time < processes[arrival_order[next_arrival]].arrival_time)
+        {
+            current_time = processes[arrival_order[next_arrival]].arrival_time;
+        }
+
+        // Age the waiting processes, then queue the new arrivals
+        aging_steps += age_waiting_processes(processes, &ready, &aging, current_time,
+                                             aging_interval, priority_floor);
+        while (next_arrival < n && processes[arrival_order[next_arrival]].arrival_time <= current_time)
+        {
+            int i = arrival_order[next_arrival++];
+            queue_waiting_process(processes, &ready, &aging, i, rank[i], current_time,
+                                  aging_interval, priority_floor);
+        }
+
+        // Dispatch the best waiting process if the CPU is free or it wins
+        if (ready.size > 0)
+        {
+            int best = ready.items[0];
+            if (running == -1 || processes[best].effective_priority < processes[running].effective_priority)
+            {
+                if (running != -1)
+                {
+                    requeue_preempted_process(processes, &ready, &aging, running, rank[running],
+                                              current_time);
+                    preemptions++;
+                }
+                dispatch_waiting_process(processes, &ready, &aging, best, current_time);
+                running = best;
+            }
+        }
+
+        // Run until the next arrival, aging step or completion
+        long long next_event = current_time + processes[running].remaining_time;
+        if (next_arrival < n && processes[arrival_order[next_arrival]].arrival_time < next_event)
+        {
+            next_event = processes[arrival_order[next_arrival]].arrival_time;
+        }
+        if (aging.size > 0 && aging.key[aging.items[0]] < next_event)
+        {
+            next_event = aging.key[aging.items[0]];
+        }
+        processes[running].remaining_time -= (int)(next_event - current_time);
+        current_time = next_event;
+
+        if (processes[running].remaining_time == 0)
+        {
+            Process *process = &processes[running];
+            process->turnaround_time = (int)(current_time - process->arrival_time);
+            process->waiting_time = process->turnaround_time - process->burst_time;
+
+            total_waiting_time += process->waiting_time;
+            total_turnaround_time += process->turnaround_time;
+            completed_processes++;
+            running = -1;
+        }
+    }
+    free(arrival_order);
+    free(rank);
+    free_indexed_heap(&ready);
+    free_indexed_heap(&aging);
+
+    // Print results
+    printf("\n--- Preemptive Priority Scheduling Results ---\n");
+    printf("Aging Interval: %d\n", aging_interval);
+    display_process_details(processes, n);
+
+    printf("\nAverage Waiting Time: %.2f\n",
+           (double)total_waiting_time / n);
+    printf("Average Turnaround Time: %.2f\n",
+           (double)total_turnaround_time / n);
+    printf("Preemptions: %d\n", preemptions);
+    printf("Aging Steps: %lld\n", aging_steps);
 }
 
 // Display process details
@@ -151,11 +831,553 @@ void display_process_details(Process processes[], int n)
     }
 }
 
+// Policies the trace simulator can run
+typedef enum SchedulingPolicy
+{
+    POLICY_PRIORITY,
+    POLICY_ROUND_ROBIN,
+    POLICY_MLFQ,
+    POLICY_PREEMPTIVE_PRIORITY
+} SchedulingPolicy;
+
+const char *policy_names[] = {"Priority", "Round Robin", "Multilevel Feedback Queue", "Preemptive Priority"};
+const char *policy_options[] = {"priority", "rr", "mlfq", "preemptive"};
+#define NUM_POLICIES 4
+
+// State of a streaming simulation: the shared trace stream plus the
+// process slots and the ready queue that indexes them. The ready queue is
+// a heap on priority, a circular FIFO for round robin, the per-level FIFOs
+// of the MLFQ or, for preemptive priority, indexed heaps of waiting
+// processes and of their next aging steps.
+typedef struct TraceSimulation
+{
+    TraceStream stream;
+    SchedulingPolicy policy;
+    Process *slots;
+    int *ready;
+    int ready_head; // Front of the round robin FIFO
+    MlfqQueues mlfq;
+    MlfqConfig mlfq_config;
+    IndexedHeap priority_queue;
+    IndexedHeap aging_queue;
+    int aging_interval;
+    int priority_floor;
+    long long level_dispatches[MLFQ_MAX_LEVELS];
+    long long boosts;
+    long long aging_steps;
+} TraceSimulation;
+
+// Function to order two ready processes: lower priority number first,
+// ties going to the earlier arrival and then the lower ID
+int comes_first(const Process slots[], int a, int b)
+{
+    if (slots[a].priority != slots[b].priority)
+    {
+        return slots[a].priority < slots[b].priority;
+    }
+    if (slots[a].arrival_time != slots[b].arrival_time)
+    {
+        return slots[a].arrival_time < slots[b].arrival_time;
+    }
+    return slots[a].process_id < slots[b].process_id;
+}
+
+// Function to add a slot to the ready queue; level only matters for MLFQ
+void push_ready(TraceSimulation *sim, int slot, int level)
+{
+    int *ready = sim->ready;
+    int *ready_count = &sim->stream.ready_count;
+
+    if (sim->policy == POLICY_MLFQ)
+    {
+        mlfq_push(&sim->mlfq, level, slot);
+        (*ready_count)++;
+        return;
+    }
+    if (sim->policy == POLICY_PREEMPTIVE_PRIORITY)
+    {
+        queue_waiting_process(sim->slots, &sim->priority_queue, &sim->aging_queue, slot,
+                              sim->slots[slot].process_id, sim->slots[slot].arrival_time,
+                              sim->aging_interval, sim->priority_floor);
+        (*ready_count)++;
+        return;
+    }
+    if (sim->policy == POLICY_ROUND_ROBIN)
+    {
+        ready[(sim->ready_head + (*ready_count)++) % sim->stream.capacity] = slot;
+        return;
+    }
+
+    int pos = (*ready_count)++;
+    while (pos > 0)
+    {
+        int parent = (pos - 1) / 2;
+        if (!comes_first(sim->slots, slot, ready[parent]))
+        {
+            break;
+        }
+        ready[pos] = ready[parent];
+        pos = parent;
+    }
+    ready[pos] = slot;
+}
+
+// Function to remove the next slot to run from the ready queue, and the
+// MLFQ level it came from
+int pop_ready(TraceSimulation *sim, int *level)
+{
+    int *ready = sim->ready;
+    int *ready_count = &sim->stream.ready_count;
+
+    *level = 0;
+    if (sim->policy == POLICY_MLFQ)
+    {
+        (*ready_count)--;
+        return mlfq_pop(&sim->mlfq, level);
+    }
+    if (sim->policy == POLICY_ROUND_ROBIN)
+    {
+        int slot = ready[sim->ready_head];
+        sim->ready_head = (sim->ready_head + 1) % sim->stream.capacity;
+        (*ready_count)--;
+        return slot;
+    }
+
+    int top = ready[0];
+    int last = ready[--(*ready_count)];
+    int pos = 0;
+    for (;;)
+    {
+        int child = 2 * pos + 1;
+        if (child >= *ready_count)
+        {
+            break;
+        }
+        if (child + 1 < *ready_count && comes_first(sim->slots, ready[child + 1], ready[child]))
+        {
+            child++;
+        }
+        if (!comes_first(sim->slots, ready[child], last))
+        {
+            break;
+        }
+        ready[pos] = ready[child];
+        pos = child;
+    }
+    ready[pos] = last;
+    return top;
+}
+
+// Function to resize the process slots and every ready queue structure;
+// returns 0 if memory cannot be allocated
+int grow_trace_slots(void *context, int old_capacity, int capacity)
+{
+    TraceSimulation *sim = context;
+
+    Process *slots = realloc(sim->slots, sizeof(Process) * capacity);
+    if (slots != NULL)
+    {
+        sim->slots = slots;
+    }
+    int *ready = realloc(sim->ready, sizeof(int) * capacity);
+    if (ready != NULL)
+    {
+        sim->ready = ready;
+    }
+    int *next = realloc(sim->mlfq.next, sizeof(int) * capacity);
+    if (next != NULL)
+    {
+        sim->mlfq.next = next;
+    }
+    int heaps = sim->policy != POLICY_PREEMPTIVE_PRIORITY ||
+                (grow_indexed_heap(&sim->priority_queue, old_capacity, capacity) &&
+                 grow_indexed_heap(&sim->aging_queue, old_capacity, capacity));
+    if (slots == NULL || ready == NULL || next == NULL || !heaps)
+    {
+        return 0;
+    }
+
+    // Unwrap a FIFO that ran past the end of the old buffer
+    int wrapped = sim->ready_head + sim->stream.ready_count - old_capacity;
+    if (wrapped > 0)
+    {
+        memcpy(sim->ready + old_capacity, sim->ready, sizeof(int) * wrapped);
+    }
+    return 1;
+}
+
+// Function to fill a slot from a trace record and add it to the ready queue
+void admit_trace_process(void *context, int slot, int process_id, const TraceRecord *record)
+{
+    TraceSimulation *sim = context;
+    Process *process = &sim->slots[slot];
+
+    process->process_id = process_id;
+    process->arrival_time = record->arrival_time;
+    process->burst_time = record->burst_time;
+    process->remaining_time = record->burst_time;
+    process->priority = record->priority;
+    push_ready(sim, slot, 0);
+}
+
+// Function to run a policy over the whole trace; returns 0 on error
+// Priority scheduling is non-preemptive and, unlike priority_scheduling(),
+// only considers processes that have arrived. Under round robin, processes
+// arriving during a quantum queue ahead of the one it preempts; the MLFQ
+// follows mlfq_scheduling().
+int simulate_trace(TraceSimulation *sim, int time_quantum)
+{
+    TraceStream *stream = &sim->stream;
+    TraceMetrics *metrics = &stream->metrics;
+    const MlfqConfig *config = &sim->mlfq_config;
+    long long current_time = 0;
+    long long next_boost = config->boost_interval;
+    int preempted = -1; // Slot waiting to rejoin the queue after a quantum
+    int preempted_level = 0;
+
+    if (!read_trace_record(stream))
+    {
+        return 0;
+    }
+
+    while (stream->has_next || stream->ready_count > 0 || preempted != -1)
+    {
+        // If no process is available, skip ahead to the next arrival
+        if (stream->ready_count == 0 && preempted == -1 && current_time < stream->next.arrival_time)
+        {
+            current_time = stream->next.arrival_time;
+        }
+        if (!admit_arrivals(stream, current_time))
+        {
+            return 0;
+        }
+
+        int boost = sim->policy == POLICY_MLFQ && config->boost_interval > 0 && current_time >= next_boost;
+        if (boost)
+        {
+            mlfq_boost(&sim->mlfq);
+            sim->boosts++;
+            next_boost = (current_time / config->boost_interval + 1) * config->boost_interval;
+        }
+
+        if (preempted != -1)
+        {
+            int level = preempted_level + 1 < config->levels ? preempted_level + 1 : preempted_level;
+            push_ready(sim, preempted, boost ? 0 : level);
+            preempted = -1;
+        }
+
+        int level;
+        int slot = pop_ready(sim, &level);
+        Process *process = &sim->slots[slot];
+        record_dispatch(metrics, process->process_id);
+        sim->level_dispatches[level]++;
+
+        // Run for one quantum, or to completion under priority scheduling
+        int run_time = process->remaining_time;
+        if (sim->policy == POLICY_ROUND_ROBIN && run_time > time_quantum)
+        {
+            run_time = time_quantum;
+        }
+        if (sim->policy == POLICY_MLFQ && run_time > config->time_quantum[level])
+        {
+            run_time = config->time_quantum[level];
+        }
+        current_time += run_time;
+        process->remaining_time -= run_time;
+
+        if (process->remaining_time > 0)
+        {
+            preempted = slot;
+            preempted_level = level;
+            continue;
+        }
+        record_completion(metrics, process->arrival_time, process->burst_time, current_time);
+        release_trace_slot(stream, slot);
+    }
+    return 1;
+}
+
+// Function to run preemptive priority scheduling with aging over the
+// trace; returns 0 on error. Follows preemptive_priority_scheduling(),
+// with process IDs, which rise in arrival order, breaking ties.
+int simulate_aging_trace(TraceSimulation *sim)
+{
+    TraceStream *stream = &sim->stream;
+    TraceMetrics *metrics = &stream->metrics;
+    IndexedHeap *ready = &sim->priority_queue;
+    IndexedHeap *aging = &sim->aging_queue;
+    long long current_time = 0;
+    int running = -1; // Slot of the process on the CPU
+
+    if (!read_trace_record(stream))
+    {
+        return 0;
+    }
+
+    while (stream->has_next || ready->size > 0 || running != -1)
+    {
+        // If no process is available, skip ahead to the next arrival
+        if (running == -1 && ready->size == 0 && current_time < stream->next.arrival_time)
+        {
+            current_time = stream->next.arrival_time;
+        }
+
+        // Age the waiting processes, then queue the new arrivals
+        sim->aging_steps += age_waiting_processes(sim->slots, ready, aging, current_time,
+                                                  sim->aging_interval, sim->priority_floor);
+        if (!admit_arrivals(stream, current_time))
+        {
+            return 0;
+        }
+
+        // Dispatch the best waiting process if the CPU is free or it wins
+        if (ready->size > 0)
+        {
+            int best = ready->items[0];
+            if (running == -1 || sim->slots[best].effective_priority < sim->slots[running].effective_priority)
+            {
+                if (running != -1)
+                {
+                    requeue_preempted_process(sim->slots, ready, aging, running,
+                                              sim->slots[running].process_id, current_time);
+                    stream->ready_count++;
+                    metrics->preemptions++;
+                }
+                dispatch_waiting_process(sim->slots, ready, aging, best, current_time);
+                stream->ready_count--;
+                running = best;
+
+                record_dispatch(metrics, sim->slots[running].process_id);
+            }
+        }
+
+        // Run until the next arrival, aging step or completion
+        Process *process = &sim->slots[running];
+        long long next_event = current_time + process->remaining_time;
+        if (stream->has_next && stream->next.arrival_time < next_event)
+        {
+            next_event = stream->next.arrival_time;
+        }
+        if (aging->size > 0 && aging->key[aging->items[0]] < next_event)
+        {
+            next_event = aging->key[aging->items[0]];
+        }
+        process->remaining_time -= (int)(next_event - current_time);
+        current_time = next_event;
+
+        if (process->remaining_time == 0)
+        {
+            record_completion(metrics, process->arrival_time, process->burst_time, current_time);
+            release_trace_slot(stream, running);
+            running = -1;
+        }
+    }
+    return 1;
+}
+
+// Function to find the best (lowest) priority in a trace, the level at
+// which aging stops; returns 0 if the trace has a malformed line
+int find_priority_floor(const ProcessTrace *trace, int *priority_floor)
+{
+    ProcessTrace scan = *trace;
+    TraceRecord record;
+    int status;
+
+    *priority_floor = INT_MAX;
+    while ((status = next_trace_record(&scan, &record)) == 1)
+    {
+        if (record.priority < *priority_floor)
+        {
+            *priority_floor = record.priority;
+        }
+    }
+    return status == 0;
+}
+
+// Function to stream a trace file through sim->policy, timing the run;
+// returns 0 if the trace is malformed or memory runs out
+int simulate_trace_file(TraceSimulation *sim, const char *path, int time_quantum, double *seconds)
+{
+    TraceHooks hooks = {grow_trace_slots, admit_trace_process, sim};
+    if (!open_trace_stream(&sim->stream, path, hooks))
+    {
+        return 0;
+    }
+
+    // Aging stops at the best priority in the trace, found by a first pass
+    int preemptive = sim->policy == POLICY_PREEMPTIVE_PRIORITY;
+    if (preemptive && !find_priority_floor(&sim->stream.trace, &sim->priority_floor))
+    {
+        close_trace_stream(&sim->stream);
+        return 0;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int ok = preemptive ? simulate_aging_trace(sim) : simulate_trace(sim, time_quantum);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    close_trace_stream(&sim->stream);
+    free(sim->slots);
+    free(sim->ready);
+    free(sim->mlfq.next);
+    free_indexed_heap(&sim->priority_queue);
+    free_indexed_heap(&sim->aging_queue);
+    return ok;
+}
+
+// Function to run the streaming trace mode:
+// priority_robin --trace priority <file>
+// priority_robin --trace rr <file> <time quantum>
+// priority_robin --trace mlfq <file> <levels> <base quantum | q0,q1,...> [boost interval]
+// priority_robin --trace preemptive <file> <aging interval>
+int run_trace_simulation(int argc, char *argv[])
+{
+    TraceSimulation sim;
+    memset(&sim, 0, sizeof(sim));
+
+    int policy = -1;
+    for (int i = 0; argc >= 2 && i < NUM_POLICIES; i++)
+    {
+        if (strcmp(argv[0], policy_options[i]) == 0)
+        {
+            policy = i;
+        }
+    }
+
+    int time_quantum = 0;
+    if (policy == POLICY_ROUND_ROBIN && argc == 3)
+    {
+        time_quantum = atoi(argv[2]);
+    }
+    sim.aging_interval = -1;
+    if (policy == POLICY_PREEMPTIVE_PRIORITY && argc == 3)
+    {
+        sim.aging_interval = atoi(argv[2]);
+    }
+    int valid_mlfq = policy == POLICY_MLFQ && (argc == 4 || argc == 5) &&
+                     parse_mlfq_config(&sim.mlfq_config, atoi(argv[2]), argv[3],
+                                       argc == 5 ? atoi(argv[4]) : 0);
+    if ((policy == POLICY_PRIORITY && argc != 2) ||
+        (policy == POLICY_ROUND_ROBIN && time_quantum <= 0) ||
+        (policy == POLICY_MLFQ && !valid_mlfq) ||
+        (policy == POLICY_PREEMPTIVE_PRIORITY && sim.aging_interval < 0) || policy == -1)
+    {
+        printf("Usage: priority_robin --trace priority <file> | --trace rr <file> <time quantum> |\n"
+               "       --trace mlfq <file> <levels <= %d> <base quantum | q0,q1,...> [boost interval] |\n"
+               "       --trace preemptive <file> <aging interval, 0 for none>\n",
+               MLFQ_MAX_LEVELS);
+        return 1;
+    }
+
+    sim.policy = (SchedulingPolicy)policy;
+    double seconds;
+    if (!simulate_trace_file(&sim, argv[1], time_quantum, &seconds))
+    {
+        return 1;
+    }
+
+    const TraceMetrics *metrics = &sim.stream.metrics;
+
+    printf("\n--- %s Trace Simulation: %s ---\n", policy_names[policy], argv[1]);
+    if (policy == POLICY_ROUND_ROBIN)
+    {
+        printf("Time Quantum: %d\n", time_quantum);
+    }
+    if (policy == POLICY_PREEMPTIVE_PRIORITY)
+    {
+        printf("Aging Interval: %d\n", sim.aging_interval);
+    }
+    if (!print_trace_metrics(metrics))
+    {
+        return 0;
+    }
+    printf("Peak Ready Queue: %d\n", metrics->peak_ready);
+    if (policy == POLICY_MLFQ)
+    {
+        display_mlfq_levels(&sim.mlfq_config, sim.level_dispatches, sim.boosts);
+    }
+    if (policy == POLICY_PREEMPTIVE_PRIORITY)
+    {
+        printf("Preemptions: %lld\n", metrics->preemptions);
+        printf("Aging Steps: %lld\n", sim.aging_steps);
+    }
+    print_trace_timing(metrics, seconds);
+    return 0;
+}
+
+// Function to check the trace metrics of the preemptive policies on a
+// trace whose first arrival is the last to complete:
+// priority_robin --trace-check
+int run_trace_check()
+{
+    const char text[] = "0 10 5\n1 1 1\n";
+    char path[] = "/tmp/priority_robin_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || write(fd, text, sizeof(text) - 1) != (ssize_t)(sizeof(text) - 1))
+    {
+        printf("Error: Could not write a check trace!\n");
+        if (fd >= 0)
+        {
+            close(fd);
+            unlink(path);
+        }
+        return 1;
+    }
+    close(fd);
+
+    SchedulingPolicy policies[] = {POLICY_ROUND_ROBIN, POLICY_MLFQ, POLICY_PREEMPTIVE_PRIORITY};
+    int num_policies = sizeof(policies) / sizeof(policies[0]);
+    int mismatches = 0;
+    for (int i = 0; i < num_policies; i++)
+    {
+        TraceSimulation sim;
+        memset(&sim, 0, sizeof(sim));
+        sim.policy = policies[i];
+        make_mlfq_config(&sim.mlfq_config, 3, 2, 20);
+
+        double seconds;
+        if (!simulate_trace_file(&sim, path, 2, &seconds))
+        {
+            unlink(path);
+            return 1;
+        }
+
+        // Both processes arrive by time 1 and the CPU is never idle after 0
+        const TraceMetrics *metrics = &sim.stream.metrics;
+        long long span = metrics->last_completion - metrics->first_arrival;
+        if (metrics->processes != 2 || metrics->first_arrival != 0 || metrics->busy_time != span)
+        {
+            printf("Mismatch under %s: first arrival %lld, busy %lld of %lld\n",
+                   policy_names[policies[i]], metrics->first_arrival, metrics->busy_time, span);
+            mismatches++;
+        }
+    }
+    unlink(path);
+
+    printf("Checked %d policies: %d mismatches\n", num_policies, mismatches);
+    return mismatches > 0 ? 1 : 0;
+}
+
 // Main function to demonstrate scheduling
-int main()
+int main(int argc, char *argv[])
 {
+    // Streaming trace mode
+    if (argc > 1 && strcmp(argv[1], "--trace") == 0)
+    {
+        return run_trace_simulation(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "--trace-check") == 0)
+    {
+        return run_trace_check();
+    }
+
     Process priority_processes[MAX_PROCESSES];
     Process rr_processes[MAX_PROCESSES];
+    Process mlfq_processes[MAX_PROCESSES];
+    Process preemptive_processes[MAX_PROCESSES];
     int n, time_quantum;
 
     // Input process details
@@ -187,6 +1409,9 @@ int main()
         printf("Priority (lower number = higher priority): ");
         scanf("%d", &priority_processes[i].priority);
         rr_processes[i].priority = priority_processes[i].priority;
+
+        mlfq_processes[i] = rr_processes[i];
+        preemptive_processes[i] = rr_processes[i];
     }
 
     // Perform Priority Scheduling
@@ -195,5 +1420,16 @@ int main()
     // Perform Round Robin Scheduling
     round_robin_scheduling(rr_processes, n, time_quantum);
 
+    // Perform MLFQ Scheduling: three levels starting at the Round Robin
+    // quantum, boosted every ten quanta
+    MlfqConfig mlfq_config;
+    if (make_mlfq_config(&mlfq_config, 3, time_quantum, 10 * time_quantum))
+    {
+        mlfq_scheduling(mlfq_processes, n, &mlfq_config);
+    }
+
+    // Perform Preemptive Priority Scheduling with aging
+    preemptive_priority_scheduling(preemptive_processes, n, DEFAULT_AGING_INTERVAL);
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,119 @@
+#ifndef PROCESS_SORT_H
+#define PROCESS_SORT_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Stable sorting of process tables on one integer field, shared by the
+// scheduler programs. Callers collect the keys into an int array; the sort
+// reorders (key, index) pairs with an LSD radix sort, one counting pass per
+// key byte, so the wide Process records are moved only once at the end.
+
+#define SORT_RADIX_BITS 8
+#define SORT_RADIX (1 << SORT_RADIX_BITS)
+
+// Function to stably sort the indices 0..n-1 by keys[] into order[]
+// Bytes that every key shares are skipped, so small keys such as arrival
+// times or priorities usually need one or two passes. Returns 0 if scratch
+// memory cannot be allocated.
+static inline int sort_indices_by_key(const int keys[], int order[], int n)
+{
+    if (n < 2)
+    {
+        if (n == 1)
+        {
+            order[0] = 0;
+        }
+        return 1;
+    }
+
+    uint64_t *items = malloc(sizeof(uint64_t) * 2 * (size_t)n);
+    if (items == NULL)
+    {
+        return 0;
+    }
+    uint64_t *scratch = items + n;
+
+    // Flipping the sign bit makes unsigned order match signed order; the
+    // key sits in the high half so the index rides along with it
+    uint32_t all_or = 0, all_and = UINT32_MAX;
+    for (int i = 0; i < n; i++)
+    {
+        uint32_t bits = (uint32_t)keys[i] ^ 0x80000000u;
+        items[i] = ((uint64_t)bits << 32) | (uint32_t)i;
+        all_or |= bits;
+        all_and &= bits;
+    }
+    uint32_t varying = all_or ^ all_and;
+
+    for (int shift = 32; shift < 64; shift += SORT_RADIX_BITS)
+    {
+        if (((varying >> (shift - 32)) & (SORT_RADIX - 1)) == 0)
+        {
+            continue;
+        }
+
+        int count[SORT_RADIX] = {0};
+        for (int i = 0; i < n; i++)
+        {
+            count[(items[i] >> shift) & (SORT_RADIX - 1)]++;
+        }
+
+        int position = 0;
+        for (int digit = 0; digit < SORT_RADIX; digit++)
+        {
+            int digit_count = count[digit];
+            count[digit] = position;
+            position += digit_count;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            scratch[count[(items[i] >> shift) & (SORT_RADIX - 1)]++] = items[i];
+        }
+
+        uint64_t *swap = items;
+        items = scratch;
+        scratch = swap;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        order[i] = (int)(uint32_t)items[i];
+    }
+
+    free(items < scratch ? items : scratch);
+    return 1;
+}
+
+// Function to stably reorder n records of record_size bytes by keys[]
+// Returns 0 if scratch memory cannot be allocated.
+static inline int sort_records_by_key(void *records, size_t record_size, const int keys[], int n)
+{
+    if (n < 2)
+    {
+        return 1;
+    }
+
+    int *order = malloc(sizeof(int) * (size_t)n);
+    char *sorted = malloc(record_size * (size_t)n);
+    if (order == NULL || sorted == NULL || !sort_indices_by_key(keys, order, n))
+    {
+        free(order);
+        free(sorted);
+        return 0;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        memcpy(sorted + record_size * i, (char *)records + record_size * order[i], record_size);
+    }
+    memcpy(records, sorted, record_size * (size_t)n);
+
+    free(order);
+    free(sorted);
+    return 1;
+}
+
+#endif
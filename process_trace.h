@@ -0,0 +1,389 @@
+#ifndef PROCESS_TRACE_H
+#define PROCESS_TRACE_H
+
+// madvise and MADV_SEQUENTIAL under -std=c11; programs that include other
+// system headers first must define this themselves
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Streaming reader for scheduler traces, shared by the scheduler programs.
+// A trace holds one process per line as "arrival burst [priority]"; blank
+// lines and lines starting with '#' are skipped. The file is memory-mapped
+// and parsed in place, so records are never copied into a table and a
+// trace of any length costs only the pages being read. On top of the
+// reader, a TraceStream admits processes as the simulated clock reaches
+// them and keeps the metrics every scheduler reports.
+
+typedef struct ProcessTrace
+{
+    const char *data; // Mapped file contents, NULL for an empty file
+    size_t size;
+    size_t pos;       // Offset of the next unread byte
+    long line;        // Lines consumed so far; a record is on line + 1
+    const char *path;
+    int fd;
+} ProcessTrace;
+
+typedef struct TraceRecord
+{
+    int arrival_time;
+    int burst_time;
+    int priority; // 0 when the line has no priority field
+} TraceRecord;
+
+// Function to map a trace file for reading; returns 0 on error
+static inline int open_process_trace(ProcessTrace *trace, const char *path)
+{
+    struct stat info;
+
+    trace->data = NULL;
+    trace->size = 0;
+    trace->pos = 0;
+    trace->line = 0;
+    trace->path = path;
+    trace->fd = open(path, O_RDONLY);
+    if (trace->fd < 0 || fstat(trace->fd, &info) != 0)
+    {
+        printf("Error: Could not open trace %s!\n", path);
+        if (trace->fd >= 0)
+        {
+            close(trace->fd);
+        }
+        return 0;
+    }
+
+    trace->size = (size_t)info.st_size;
+    if (trace->size > 0)
+    {
+        void *data = mmap(NULL, trace->size, PROT_READ, MAP_PRIVATE, trace->fd, 0);
+        if (data == MAP_FAILED)
+        {
+            printf("Error: Could not map trace %s!\n", path);
+            close(trace->fd);
+            return 0;
+        }
+        madvise(data, trace->size, MADV_SEQUENTIAL);
+        trace->data = data;
+    }
+    return 1;
+}
+
+// Function to unmap a trace file
+static inline void close_process_trace(ProcessTrace *trace)
+{
+    if (trace->data != NULL)
+    {
+        munmap((void *)trace->data, trace->size);
+    }
+    close(trace->fd);
+}
+
+// Function to parse one decimal field of a record; returns 0 if there is
+// no number or it does not fit in an int
+static inline int parse_trace_field(ProcessTrace *trace, int *value)
+{
+    const char *data = trace->data;
+    size_t pos = trace->pos;
+
+    while (pos < trace->size && (data[pos] == ' ' || data[pos] == '\t'))
+    {
+        pos++;
+    }
+
+    int negative = pos < trace->size && data[pos] == '-';
+    pos += negative;
+
+    size_t first_digit = pos;
+    long long number = 0;
+    while (pos < trace->size && data[pos] >= '0' && data[pos] <= '9')
+    {
+        number = number * 10 + (data[pos++] - '0');
+        if (number > INT_MAX)
+        {
+            return 0;
+        }
+    }
+
+    trace->pos = pos;
+    *value = (int)(negative ? -number : number);
+    return pos > first_digit;
+}
+
+// Function to read the next record of a trace
+// Returns 1 for a record, 0 at the end of the trace and -1 (after printing
+// an error) for a malformed line.
+static inline int next_trace_record(ProcessTrace *trace, TraceRecord *record)
+{
+    const char *data = trace->data;
+
+    while (trace->pos < trace->size)
+    {
+        char c = data[trace->pos];
+        if (c == '\n')
+        {
+            trace->line++;
+            trace->pos++;
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\r')
+        {
+            trace->pos++;
+            continue;
+        }
+        if (c == '#')
+        {
+            while (trace->pos < trace->size && data[trace->pos] != '\n')
+            {
+                trace->pos++;
+            }
+            continue;
+        }
+
+        record->priority = 0;
+        int valid = parse_trace_field(trace, &record->arrival_time) &&
+                    parse_trace_field(trace, &record->burst_time) &&
+                    record->arrival_time >= 0 && record->burst_time > 0;
+
+        // Optional priority, then nothing but blanks up to the end of line
+        while (valid && trace->pos < trace->size && (data[trace->pos] == ' ' || data[trace->pos] == '\t'))
+        {
+            trace->pos++;
+        }
+        if (valid && trace->pos < trace->size && data[trace->pos] != '\n' && data[trace->pos] != '\r')
+        {
+            valid = parse_trace_field(trace, &record->priority);
+        }
+        while (valid && trace->pos < trace->size && (data[trace->pos] == ' ' || data[trace->pos] == '\t' || data[trace->pos] == '\r'))
+        {
+            trace->pos++;
+        }
+        if (!valid || (trace->pos < trace->size && data[trace->pos] != '\n'))
+        {
+            printf("Error: Bad trace line %ld in %s!\n", trace->line + 1, trace->path);
+            return -1;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+
+// Aggregate results of a trace simulation; nothing is kept per process
+typedef struct TraceMetrics
+{
+    long long processes;
+    long long total_waiting_time;
+    long long total_turnaround_time;
+    long long max_waiting_time;
+    long long busy_time; // Time the CPU spent running processes
+    long long first_arrival;
+    long long last_completion;
+    long long dispatches;       // Times a process was put on the CPU
+    long long context_switches; // Dispatches that changed the running process
+    long long preemptions;
+    int last_process; // ID of the last process dispatched, 0 before the first
+    int peak_ready;   // Most processes waiting at once
+} TraceMetrics;
+
+// Callbacks through which a scheduler keeps its own process slots and
+// ready queue in step with the stream
+typedef struct TraceHooks
+{
+    // Resize the per-slot arrays from old_capacity to capacity; returns 0
+    // if memory cannot be allocated
+    int (*grow)(void *context, int old_capacity, int capacity);
+    // Fill a slot from a record and add it to the ready queue
+    void (*admit)(void *context, int slot, int process_id, const TraceRecord *record);
+    void *context;
+} TraceHooks;
+
+// State of a streaming simulation. Records are read only when the clock
+// reaches their arrival, and admitted processes live in reusable slots
+// until they complete, so memory follows the ready queue, not the trace.
+typedef struct TraceStream
+{
+    ProcessTrace trace;
+    TraceRecord next; // First record not yet admitted
+    int has_next;
+    int last_arrival;
+    int admitted; // Processes read so far, used as process IDs
+    int *free_slots;
+    int capacity;
+    int used_slots;  // Slots ever handed out
+    int free_count;
+    int ready_count; // Kept by the scheduler's ready queue
+    TraceHooks hooks;
+    TraceMetrics metrics;
+} TraceStream;
+
+// Function to open a trace for streaming; returns 0 on error
+static inline int open_trace_stream(TraceStream *stream, const char *path, TraceHooks hooks)
+{
+    memset(stream, 0, sizeof(*stream));
+    stream->hooks = hooks;
+    return open_process_trace(&stream->trace, path);
+}
+
+// Function to close a trace stream and free its slot pool
+static inline void close_trace_stream(TraceStream *stream)
+{
+    close_process_trace(&stream->trace);
+    free(stream->free_slots);
+}
+
+// Function to read the next trace record into stream->next; returns 0 on
+// a malformed or out-of-order record
+static inline int read_trace_record(TraceStream *stream)
+{
+    int status = next_trace_record(&stream->trace, &stream->next);
+    if (status < 0)
+    {
+        return 0;
+    }
+
+    stream->has_next = status;
+    if (status == 1 && stream->next.arrival_time < stream->last_arrival)
+    {
+        printf("Error: Trace %s is not sorted by arrival time at line %ld!\n",
+               stream->trace.path, stream->trace.line + 1);
+        return 0;
+    }
+    if (status == 1)
+    {
+        stream->last_arrival = stream->next.arrival_time;
+    }
+    return 1;
+}
+
+// Function to take a process slot, growing the pool when all are in use
+static inline int take_trace_slot(TraceStream *stream)
+{
+    if (stream->free_count > 0)
+    {
+        return stream->free_slots[--stream->free_count];
+    }
+
+    if (stream->used_slots == stream->capacity)
+    {
+        int capacity = stream->capacity > 0 ? stream->capacity * 2 : 1024;
+        int *free_slots = realloc(stream->free_slots, sizeof(int) * capacity);
+        if (free_slots != NULL)
+        {
+            stream->free_slots = free_slots;
+        }
+        if (free_slots == NULL || !stream->hooks.grow(stream->hooks.context, stream->capacity, capacity))
+        {
+            printf("Error: Memory allocation failed!\n");
+            return -1;
+        }
+        stream->capacity = capacity;
+    }
+    return stream->used_slots++;
+}
+
+// Function to return the slot of a finished process to the pool
+static inline void release_trace_slot(TraceStream *stream, int slot)
+{
+    stream->free_slots[stream->free_count++] = slot;
+}
+
+// Function to admit every process that has arrived by current_time;
+// returns 0 on error
+static inline int admit_arrivals(TraceStream *stream, long long current_time)
+{
+    while (stream->has_next && stream->next.arrival_time <= current_time)
+    {
+        int slot = take_trace_slot(stream);
+        if (slot == -1)
+        {
+            return 0;
+        }
+
+        stream->hooks.admit(stream->hooks.context, slot, ++stream->admitted, &stream->next);
+
+        if (!read_trace_record(stream))
+        {
+            return 0;
+        }
+    }
+
+    if (stream->ready_count > stream->metrics.peak_ready)
+    {
+        stream->metrics.peak_ready = stream->ready_count;
+    }
+    return 1;
+}
+
+// Function to count a process being put on the CPU
+static inline void record_dispatch(TraceMetrics *metrics, int process_id)
+{
+    metrics->dispatches++;
+    if (process_id != metrics->last_process && metrics->last_process != 0)
+    {
+        metrics->context_switches++;
+    }
+    metrics->last_process = process_id;
+}
+
+// Function to add a finished process to the trace metrics
+static inline void record_completion(TraceMetrics *metrics, int arrival_time, int burst_time,
+                                     long long completion_time)
+{
+    long long turnaround_time = completion_time - arrival_time;
+    long long waiting_time = turnaround_time - burst_time;
+
+    // Preemptive policies can finish a later arrival first
+    if (metrics->processes++ == 0 || arrival_time < metrics->first_arrival)
+    {
+        metrics->first_arrival = arrival_time;
+    }
+    metrics->total_waiting_time += waiting_time;
+    metrics->total_turnaround_time += turnaround_time;
+    metrics->busy_time += burst_time;
+    metrics->last_completion = completion_time;
+    if (waiting_time > metrics->max_waiting_time)
+    {
+        metrics->max_waiting_time = waiting_time;
+    }
+}
+
+// Function to print the metrics every policy shares; returns 0 if the
+// trace had no processes, in which case only the count is printed
+static inline int print_trace_metrics(const TraceMetrics *metrics)
+{
+    long long span = metrics->last_completion - metrics->first_arrival;
+
+    printf("Processes: %lld\n", metrics->processes);
+    if (metrics->processes == 0)
+    {
+        return 0;
+    }
+    printf("Average Waiting Time: %.2f\n", (double)metrics->total_waiting_time / metrics->processes);
+    printf("Average Turnaround Time: %.2f\n", (double)metrics->total_turnaround_time / metrics->processes);
+    printf("Maximum Waiting Time: %lld\n", metrics->max_waiting_time);
+    printf("CPU Utilization: %.2f%%\n", span > 0 ? 100.0 * metrics->busy_time / span : 100.0);
+    printf("Throughput: %.4f processes per time unit\n", span > 0 ? (double)metrics->processes / span : 0.0);
+    printf("Dispatches: %lld\n", metrics->dispatches);
+    printf("Context Switches: %lld\n", metrics->context_switches);
+    return 1;
+}
+
+// Function to print how long a simulation took
+static inline void print_trace_timing(const TraceMetrics *metrics, double seconds)
+{
+    printf("Simulated in %.3f s (%.0f processes/sec)\n", seconds,
+           seconds > 0 ? metrics->processes / seconds : 0.0);
+}
+
+#endif